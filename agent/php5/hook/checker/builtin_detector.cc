@@ -38,7 +38,7 @@ bool BuiltinDetector::pretreat() const
 CheckResult BuiltinDetector::check()
 {
     CheckResult cr = kNoCache;
-    if (builtin_material.builtin_check(j))
+    if (builtin_material.builtin_check())
     {
         cr = get_builtin_check_result(builtin_material.get_builtin_check_type());
     }
@@ -62,7 +62,6 @@ void BuiltinDetector::run()
     }
     else
     {
-        builtin_material.fill_json_with_params(j);
         log_alarm(cr);
         if (kBlock == cr)
         {
@@ -73,6 +72,9 @@ void BuiltinDetector::run()
 
 void BuiltinDetector::log_alarm(const CheckResult &cr)
 {
+    // the alarm document and the stack are only built once there is something to log
+    JsonReader j;
+    builtin_material.fill_json_with_params(j);
     j.write_int64({"plugin_confidence"}, 100);
     j.write_string({"plugin_name"}, "php_builtin_plugin");
     j.write_string({"attack_type"}, CheckTypeTransfer::instance().type_to_name(builtin_material.get_builtin_check_type()));
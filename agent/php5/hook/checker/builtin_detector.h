@@ -30,7 +30,6 @@ class BuiltinDetector : public Detector
 {
 protected:
     const openrasp::data::BuiltinMaterial &builtin_material;
-    JsonReader j;
 
     virtual bool pretreat() const;
     virtual CheckResult check();
@@ -29,7 +29,7 @@ public:
     virtual void fill_json_with_params(JsonReader &j) const = 0;
 
     virtual OpenRASPCheckType get_builtin_check_type() const = 0;
-    virtual bool builtin_check(JsonReader &j) const = 0;
+    virtual bool builtin_check() const = 0;
 };
 } // namespace data
 
@@ -46,7 +46,7 @@ void CallableObject::fill_json_with_params(JsonReader &j) const
     j.write_string({"plugin_message"}, "WebShell activity - Using dangerous callback method: " + function_name);
 }
 
-bool CallableObject::builtin_check(JsonReader &j) const
+bool CallableObject::builtin_check() const
 {
     bool result = false;
     std::string function_name = std::string(Z_STRVAL_P(function), Z_STRLEN_P(function));
@@ -56,7 +56,7 @@ OpenRASPCheckType EchoObject::get_builtin_check_type() const
 {
     return XSS_ECHO;
 }
-bool EchoObject::builtin_check(JsonReader &j) const
+bool EchoObject::builtin_check() const
 {
     if (!regex.empty() && openrasp::regex_search(Z_STRVAL_P(value), regex.c_str()))
     {
@@ -37,7 +37,7 @@ public:
     virtual void fill_json_with_params(JsonReader &j) const;
 
     virtual OpenRASPCheckType get_builtin_check_type() const;
-    virtual bool builtin_check(JsonReader &j) const;
+    virtual bool builtin_check() const;
 };
 
 } // namespace data
@@ -28,7 +28,7 @@ public:
     virtual bool is_valid() const = 0;
     virtual void fill_json_with_params(JsonReader &j) const = 0;
     
-    virtual bool policy_check(JsonReader &j) const = 0;
+    virtual bool policy_check() const = 0;
     virtual ulong hash() const = 0;
 };
 } // namespace data
@@ -58,7 +58,7 @@ void SqlPasswordObject::fill_json_with_params(JsonReader &j) const
     return sql_connection_object.fill_json_with_params(j);
 }
 
-bool SqlPasswordObject::policy_check(JsonReader &j) const
+bool SqlPasswordObject::policy_check() const
 {
     return openrasp::scm->is_password_weak(sql_connection_object.get_password());
 }
@@ -59,7 +59,7 @@ void SqlUsernameObject::fill_json_with_params(JsonReader &j) const
     return sql_connection_object.fill_json_with_params(j);
 }
 
-bool SqlUsernameObject::policy_check(JsonReader &j) const
+bool SqlUsernameObject::policy_check() const
 {
     static const std::multimap<std::string, std::string> database_username_blacklists = {
         {"mysql", "root"},
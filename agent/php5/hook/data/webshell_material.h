@@ -32,7 +32,7 @@ public:
     virtual OpenRASPCheckType get_builtin_check_type() const = 0;
     virtual void fill_json_with_params(JsonReader &j) const = 0;
     virtual std::vector<zval *> get_zval_ptrs() const = 0;
-    virtual bool builtin_check(JsonReader &j) const
+    virtual bool builtin_check() const
     {
         std::vector<zval *> zval_ptrs = get_zval_ptrs();
         for (zval *zval_ptr : zval_ptrs)
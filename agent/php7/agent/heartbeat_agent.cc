@@ -141,6 +141,7 @@ bool HeartBeatAgent::do_heartbeat()
 				oam->set_plugin_md5(plugin_update_pkg->get_md5().c_str());
 				oam->set_plugin_name(plugin_update_pkg->get_name().c_str());
 				oam->set_plugin_version(plugin_update_pkg->get_version().c_str());
+				scm->write_algorithm_config(plugin_update_pkg->get_algorithm_config(), oam->get_plugin_update_timestamp());
 				openrasp_error(LEVEL_DEBUG, HEARTBEAT_ERROR, _("Successfully build snapshot, version: %s, md5: %s."),
 							   plugin_update_pkg->get_version().c_str(), plugin_update_pkg->get_md5().c_str());
 				result = true;
@@ -203,6 +204,12 @@ bool HeartBeatAgent::do_heartbeat()
 #endif
 				if (write_ok)
 				{
+					// workers apply the pre-parsed blob and fall back to cloud-config.json if it is unusable
+					if (!scm->write_config_blob(dummy, config_time))
+					{
+						openrasp_error(LEVEL_DEBUG, HEARTBEAT_ERROR, _("Fail to write config blob to shared memory, config time: %ld."),
+									   config_time);
+					}
 					scm->set_config_last_update(config_time);
 					openrasp_error(LEVEL_DEBUG, HEARTBEAT_ERROR, _("Successfully update config, config time: %ld."),
 								   config_time);
@@ -44,7 +44,10 @@ bool PluginUpdatePackage::build_snapshot()
 #ifndef _WIN32
   mode_t oldmask = umask(0);
 #endif
-  bool build_successful = snapshot.Save(snapshot_abs_path);
+  // workers map snapshot.dat, it is replaced by rename instead of being rewritten in place
+  std::string snapshot_tmp_path = snapshot_abs_path + ".tmp";
+  bool build_successful = snapshot.Save(snapshot_tmp_path) &&
+                          0 == rename(snapshot_tmp_path.c_str(), snapshot_abs_path.c_str());
 #ifndef _WIN32
   umask(oldmask);
 #endif
@@ -53,20 +56,16 @@ bool PluginUpdatePackage::build_snapshot()
     openrasp_error(LEVEL_WARNING, PLUGIN_ERROR, _("Fail to write snapshot to %s, cuz of %s."),
                    snapshot_abs_path.c_str(), strerror(errno));
   }
-  std::map<std::string, std::string> buildin_action_map = CheckTypeTransfer::instance().get_buildin_action_map();
   Platform::Get()->Startup();
   Isolate *isolate = Isolate::New(&snapshot, 0);
-  extract_buildin_action(isolate, buildin_action_map);
-  std::map<OpenRASPCheckType, OpenRASPActionType> type_action_map;
-  for (auto iter = buildin_action_map.begin(); iter != buildin_action_map.end(); iter++)
+  extract_algorithm_config(isolate, algorithm_config);
+  algorithm_config.response_handlers = registered_handlers({active_plugin}, "response");
+  openrasp::scm->apply_algorithm_config(algorithm_config);
+  if (build_successful)
   {
-    type_action_map.insert({CheckTypeTransfer::instance().name_to_type(iter->first), string_to_action(iter->second)});
+    // workers keep the previous snapshot otherwise
+    openrasp::scm->set_unregistered_check_types(unregistered_check_types({active_plugin}));
   }
-  openrasp::scm->set_buildin_check_action(type_action_map);
-  openrasp::scm->set_mysql_error_codes(extract_int64_array(isolate, "RASP.algorithmConfig.sql_exception.mysql.error_code", SharedConfigBlock::MYSQL_ERROR_CODE_MAX_SIZE));
-  openrasp::scm->set_sqlite_error_codes(extract_int64_array(isolate, "RASP.algorithmConfig.sql_exception.sqlite.error_code", SharedConfigBlock::SQLITE_ERROR_CODE_MAX_SIZE));
-  openrasp::scm->build_pg_error_array(isolate);
-  openrasp::scm->build_env_key_array(isolate);
   isolate->Dispose();
   Platform::Get()->Shutdown();
   return build_successful;
@@ -82,6 +81,11 @@ std::string PluginUpdatePackage::get_name() const
   return plugin_name;
 }
 
+const AlgorithmConfig &PluginUpdatePackage::get_algorithm_config() const
+{
+  return algorithm_config;
+}
+
 std::string PluginUpdatePackage::get_md5() const
 {
   return plugin_md5;
@@ -31,6 +31,7 @@ private:
   std::string plugin_md5;
   std::string plugin_version;
   std::string plugin_name;
+  AlgorithmConfig algorithm_config;
 
 public:
   PluginUpdatePackage(std::string content, std::string version, std::string name, std::string md5);
@@ -38,6 +39,7 @@ public:
   std::string get_md5() const;
   std::string get_name() const;
   std::string get_version() const;
+  const AlgorithmConfig &get_algorithm_config() const;
 };
 } // namespace openrasp
 #endif
\ No newline at end of file
@@ -18,22 +18,29 @@
 
 #include "openrasp.h"
 #include "openrasp_hook.h"
-#include "utils/double_array_trie.h"
+#include "utils/compact_double_array_trie.h"
+#include "utils/sampler.h"
+#include "utils/dns_cache.h"
+#include "utils/load_estimator.h"
 #include <string>
+#include <atomic>
 
 namespace openrasp
 {
 class SharedConfigBlock
 {
 public:
-  static const int WHITE_ARRAY_MAX_SIZE = (200 * 200 * (DoubleArrayTrie::unit_size()) * 2);
-  static const int WEAK_PASSWORD_ARRAY_MAX_SIZE = (200 * 16 * (DoubleArrayTrie::unit_size()) * 2);
-  static const int PG_ERROR_ARRAY_MAX_SIZE = (200 * 5 * (DoubleArrayTrie::unit_size()) * 2);
-  static const int ENV_KEY_ARRAY_MAX_SIZE = (200 * 50 * (DoubleArrayTrie::unit_size()) * 2);
+  static const int WHITE_ARRAY_MAX_SIZE = CompactDoubleArrayTrie::serialized_size(200 * 200 * 2);
+  static const int WEAK_PASSWORD_ARRAY_MAX_SIZE = CompactDoubleArrayTrie::serialized_size(200 * 16 * 2);
+  static const int PG_ERROR_ARRAY_MAX_SIZE = CompactDoubleArrayTrie::serialized_size(200 * 5 * 2);
+  static const int ENV_KEY_ARRAY_MAX_SIZE = CompactDoubleArrayTrie::serialized_size(200 * 50 * 2);
   static const int MYSQL_ERROR_CODE_MAX_SIZE = 100;
   static const int PGSQL_ERROR_CODE_MAX_SIZE = 100;
   static const int SQLITE_ERROR_CODE_MAX_SIZE = 100;
   static const int WEBSHELL_ENV_KEY_MAX_SIZE = 200;
+  static const int CONFIG_BLOB_MAX_SIZE = 128 * 1024;
+  static const int ALGORITHM_CONFIG_BLOB_MAX_SIZE = 64 * 1024;
+  static const int RESPONSE_SAMPLER_MAX_SIZE = 1 + 16;
 
   inline char *get_check_type_white_array()
   {
@@ -230,6 +237,151 @@ public:
     return true;
   }
 
+  /* pre-parsed ConfigHolder */
+  inline const char *get_config_blob() const
+  {
+    return config_blob;
+  }
+
+  inline size_t get_config_blob_size() const
+  {
+    return config_blob_size;
+  }
+
+  inline uint32_t get_config_blob_version() const
+  {
+    return config_blob_version;
+  }
+
+  inline uint32_t get_config_blob_checksum() const
+  {
+    return config_blob_checksum;
+  }
+
+  inline long get_config_blob_time() const
+  {
+    return config_blob_time;
+  }
+
+  inline bool reset_config_blob(const void *source, size_t num, uint32_t version, uint32_t checksum, long config_time)
+  {
+    config_blob_size = 0;
+    if (num > CONFIG_BLOB_MAX_SIZE)
+    {
+      return false;
+    }
+    memcpy((void *)&config_blob, source, num);
+    config_blob_version = version;
+    config_blob_checksum = checksum;
+    config_blob_time = config_time;
+    config_blob_size = num;
+    return true;
+  }
+
+  inline const char *get_algorithm_config_blob() const
+  {
+    return algorithm_config_blob;
+  }
+
+  inline size_t get_algorithm_config_blob_size() const
+  {
+    return algorithm_config_blob_size;
+  }
+
+  inline uint32_t get_algorithm_config_blob_version() const
+  {
+    return algorithm_config_blob_version;
+  }
+
+  inline uint32_t get_algorithm_config_blob_checksum() const
+  {
+    return algorithm_config_blob_checksum;
+  }
+
+  inline uint64_t get_algorithm_config_snapshot_timestamp() const
+  {
+    return algorithm_config_snapshot_timestamp;
+  }
+
+  inline bool reset_algorithm_config_blob(const void *source, size_t num, uint32_t version, uint32_t checksum, uint64_t snapshot_timestamp)
+  {
+    algorithm_config_blob_size = 0;
+    if (num > ALGORITHM_CONFIG_BLOB_MAX_SIZE)
+    {
+      return false;
+    }
+    memcpy((void *)&algorithm_config_blob, source, num);
+    algorithm_config_blob_version = version;
+    algorithm_config_blob_checksum = checksum;
+    algorithm_config_snapshot_timestamp = snapshot_timestamp;
+    algorithm_config_blob_size = num;
+    return true;
+  }
+
+  /* response samplers, slot 0 for urls without a matching prefix, not guarded by the lock */
+  inline Sampler *get_response_sampler(size_t slot)
+  {
+    if (slot >= RESPONSE_SAMPLER_MAX_SIZE)
+    {
+      return nullptr;
+    }
+    return &response_samplers[slot];
+  }
+
+  inline bool get_dns_cache(const std::string &host, time_t now, std::vector<std::string> &ips) const
+  {
+    return dns_cache.get(host, now, ips);
+  }
+
+  inline bool set_dns_cache(const std::string &host, const std::vector<std::string> &ips, time_t expire)
+  {
+    return dns_cache.set(host, ips, expire);
+  }
+
+  /* check types without plugin handlers, zero until plugins have been scanned, not guarded by the lock */
+  inline uint64_t get_unregistered_check_types() const
+  {
+    return unregistered_check_types.load(std::memory_order_relaxed);
+  }
+
+  inline void set_unregistered_check_types(uint64_t mask)
+  {
+    unregistered_check_types.store(mask, std::memory_order_relaxed);
+  }
+
+  /* plugin time of all workers and requests degraded by their plugin budget, not guarded by the lock */
+  inline void add_plugin_time(int64_t micros, time_t now)
+  {
+    plugin_load.add(micros, now);
+  }
+
+  inline int64_t get_plugin_load(time_t now)
+  {
+    return plugin_load.load(now);
+  }
+
+  inline void count_budget_degradation(int64_t sampled, int64_t skipped)
+  {
+    budget_degraded_requests.fetch_add(1, std::memory_order_relaxed);
+    budget_sampled_checks.fetch_add(sampled, std::memory_order_relaxed);
+    budget_skipped_checks.fetch_add(skipped, std::memory_order_relaxed);
+  }
+
+  inline int64_t get_budget_degraded_requests() const
+  {
+    return budget_degraded_requests.load(std::memory_order_relaxed);
+  }
+
+  inline int64_t get_budget_sampled_checks() const
+  {
+    return budget_sampled_checks.load(std::memory_order_relaxed);
+  }
+
+  inline int64_t get_budget_skipped_checks() const
+  {
+    return budget_skipped_checks.load(std::memory_order_relaxed);
+  }
+
 private:
   long config_update_time = 0;
   long log_max_backup = 0;
@@ -237,22 +389,45 @@ private:
   OpenRASPActionType actions[ALL_TYPE] = {AC_IGNORE};
 
   size_t white_array_size;
-  char check_type_white_array[WHITE_ARRAY_MAX_SIZE + 1];
+  alignas(8) char check_type_white_array[WHITE_ARRAY_MAX_SIZE + 1];
 
   size_t weak_password_array_size;
-  char weak_password_array[WEAK_PASSWORD_ARRAY_MAX_SIZE + 1];
+  alignas(8) char weak_password_array[WEAK_PASSWORD_ARRAY_MAX_SIZE + 1];
 
   size_t pg_error_array_size;
-  char pg_error_array[PG_ERROR_ARRAY_MAX_SIZE + 1];
+  alignas(8) char pg_error_array[PG_ERROR_ARRAY_MAX_SIZE + 1];
 
   size_t env_key_array_size;
-  char env_key_array[ENV_KEY_ARRAY_MAX_SIZE + 1];
+  alignas(8) char env_key_array[ENV_KEY_ARRAY_MAX_SIZE + 1];
 
   int mysql_error_codes_size = 0;
   long mysql_error_codes[MYSQL_ERROR_CODE_MAX_SIZE] = {0};
 
   int sqlite_error_codes_size = 0;
   long sqlite_error_codes[SQLITE_ERROR_CODE_MAX_SIZE] = {0};
+
+  uint32_t config_blob_version = 0;
+  uint32_t config_blob_checksum = 0;
+  long config_blob_time = 0;
+  size_t config_blob_size = 0;
+  char config_blob[CONFIG_BLOB_MAX_SIZE];
+
+  uint32_t algorithm_config_blob_version = 0;
+  uint32_t algorithm_config_blob_checksum = 0;
+  uint64_t algorithm_config_snapshot_timestamp = 0;
+  size_t algorithm_config_blob_size = 0;
+  char algorithm_config_blob[ALGORITHM_CONFIG_BLOB_MAX_SIZE];
+
+  Sampler response_samplers[RESPONSE_SAMPLER_MAX_SIZE];
+
+  std::atomic<uint64_t> unregistered_check_types;
+
+  LoadEstimator plugin_load;
+  std::atomic<int64_t> budget_degraded_requests;
+  std::atomic<int64_t> budget_sampled_checks;
+  std::atomic<int64_t> budget_skipped_checks;
+
+  DnsCache dns_cache;
 };
 
 } // namespace openrasp
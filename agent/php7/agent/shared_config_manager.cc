@@ -20,7 +20,7 @@
 #include "utils/digest.h"
 #include "utils/net.h"
 #include "utils/hostname.h"
-#include "openrasp_v8.h"
+#include "utils/compact_double_array_trie.h"
 #include <algorithm>
 
 namespace openrasp
@@ -42,18 +42,36 @@ SharedConfigManager::~SharedConfigManager()
     }
 }
 
-dat_value SharedConfigManager::get_check_type_white_bit_mask(std::string url)
+/**
+ * Checks a trie once after it has been copied to shared memory, lookups only validate its header,
+ * so a copy failing the checksum is replaced by an empty array.
+ */
+static bool verify_trie(const void *array, size_t size)
 {
-    DoubleArrayTrie dat;
+    CompactDoubleArrayTrie cdat;
+    return cdat.set_array(array, size) && cdat.verify();
+}
+
+static size_t host_length(const std::string &url)
+{
+    size_t found = url.find('/');
+    return found == std::string::npos ? url.length() : found;
+}
+
+dat_value SharedConfigManager::get_check_type_white_bit_mask(const std::string &url)
+{
+    CompactDoubleArrayTrie cdat;
     dat_value white_bit_mask = 0;
     if (rwlock != nullptr && rwlock->read_lock())
     {
         ReadUnLocker auto_unlocker(rwlock);
-        dat.set_array((void *)shared_config_block->get_check_type_white_array(), shared_config_block->get_white_array_size());
-        std::vector<DoubleArrayTrie::result_pair_type> result_pairs = dat.prefix_search(url.c_str());
-        for (DoubleArrayTrie::result_pair_type result_pair : result_pairs)
+        if (cdat.set_array(shared_config_block->get_check_type_white_array(), shared_config_block->get_white_array_size()))
         {
-            white_bit_mask |= result_pair.value;
+            cdat.common_prefix_search(url.c_str(), url.length(),
+                                      [&white_bit_mask](CompactDoubleArrayTrie::value_type value, size_t length) {
+                                          white_bit_mask |= value;
+                                      },
+                                      host_length(url));
         }
     }
     return white_bit_mask;
@@ -64,28 +82,48 @@ bool SharedConfigManager::write_check_type_white_array_to_shm(const void *source
     if (rwlock != nullptr && rwlock->write_lock())
     {
         WriteUnLocker auto_unlocker(rwlock);
-        shared_config_block->reset_white_array(source, num);
-        return true;
+        if (shared_config_block->reset_white_array(source, num) &&
+            verify_trie(shared_config_block->get_check_type_white_array(), shared_config_block->get_white_array_size()))
+        {
+            return true;
+        }
+        shared_config_block->reset_white_array(source, 0);
     }
     return false;
 }
 
 bool SharedConfigManager::build_check_type_white_array(std::map<std::string, dat_value> &url_mask_map)
 {
-    std::vector<std::string> urls;
-    std::vector<dat_value> values;
+    std::map<std::string, dat_value> folded_mask_map;
     for (auto iter = url_mask_map.begin(); iter != url_mask_map.end(); iter++)
+    {
+        std::string url = iter->first;
+        size_t host_len = host_length(url);
+        std::transform(url.begin(), url.begin() + host_len, url.begin(), ::tolower);
+        auto found = folded_mask_map.find(url);
+        if (found != folded_mask_map.end() && iter->second >= 0 && found->second >= 0)
+        {
+            found->second |= iter->second;
+        }
+        else
+        {
+            folded_mask_map.insert({url, iter->second});
+        }
+    }
+    std::vector<std::string> urls;
+    std::vector<int64_t> values;
+    for (auto iter = folded_mask_map.begin(); iter != folded_mask_map.end(); iter++)
     {
         urls.push_back(iter->first);
         values.push_back(iter->second);
     }
-    DoubleArrayTrie dat;
-    int error = dat.build(urls.size(), &urls, 0, &values);
-    if (error < 0 || dat.total_size() > SharedConfigBlock::WHITE_ARRAY_MAX_SIZE)
+    CompactDoubleArrayTrie cdat;
+    int error = cdat.build(urls, &values);
+    if (error < 0 || cdat.total_size() > SharedConfigBlock::WHITE_ARRAY_MAX_SIZE)
     {
         return false;
     }
-    return write_check_type_white_array_to_shm(dat.array(), dat.total_size());
+    return write_check_type_white_array_to_shm(cdat.array(), cdat.total_size());
 }
 
 bool SharedConfigManager::build_check_type_white_array(std::map<std::string, std::vector<std::string>> &url_type_map)
@@ -150,6 +188,105 @@ bool SharedConfigManager::set_config_last_update(long config_update_timestamp)
     return false;
 }
 
+bool SharedConfigManager::write_config_blob(const ConfigHolder &config, long config_time)
+{
+    std::string blob;
+    config.serialize(blob);
+    uint32_t checksum = crc32sum(blob.data(), blob.length());
+    if (rwlock != nullptr && rwlock->write_lock())
+    {
+        WriteUnLocker auto_unlocker(rwlock);
+        return shared_config_block->reset_config_blob(blob.data(), blob.length(), ConfigHolder::blob_version, checksum, config_time);
+    }
+    return false;
+}
+
+bool SharedConfigManager::load_config_blob(ConfigHolder &config, long config_time)
+{
+    if (rwlock != nullptr && rwlock->read_lock())
+    {
+        ReadUnLocker auto_unlocker(rwlock);
+        size_t size = shared_config_block->get_config_blob_size();
+        const char *data = shared_config_block->get_config_blob();
+        if (0 == size ||
+            shared_config_block->get_config_blob_time() != config_time ||
+            shared_config_block->get_config_blob_version() != ConfigHolder::blob_version ||
+            shared_config_block->get_config_blob_checksum() != crc32sum(data, size))
+        {
+            return false;
+        }
+        ConfigHolder blob_config;
+        if (!blob_config.deserialize(data, size))
+        {
+            return false;
+        }
+        config = blob_config;
+        return true;
+    }
+    return false;
+}
+
+bool SharedConfigManager::write_algorithm_config(const AlgorithmConfig &config, uint64_t snapshot_timestamp)
+{
+    std::string blob;
+    config.serialize(blob);
+    uint32_t checksum = crc32sum(blob.data(), blob.length());
+    if (rwlock != nullptr && rwlock->write_lock())
+    {
+        WriteUnLocker auto_unlocker(rwlock);
+        return shared_config_block->reset_algorithm_config_blob(blob.data(), blob.length(), AlgorithmConfig::blob_version, checksum, snapshot_timestamp);
+    }
+    return false;
+}
+
+bool SharedConfigManager::load_algorithm_config(AlgorithmConfig &config, uint64_t snapshot_timestamp)
+{
+    if (rwlock != nullptr && rwlock->read_lock())
+    {
+        ReadUnLocker auto_unlocker(rwlock);
+        size_t size = shared_config_block->get_algorithm_config_blob_size();
+        const char *data = shared_config_block->get_algorithm_config_blob();
+        if (0 == size ||
+            0 == snapshot_timestamp ||
+            shared_config_block->get_algorithm_config_snapshot_timestamp() != snapshot_timestamp ||
+            shared_config_block->get_algorithm_config_blob_version() != AlgorithmConfig::blob_version ||
+            shared_config_block->get_algorithm_config_blob_checksum() != crc32sum(data, size))
+        {
+            return false;
+        }
+        AlgorithmConfig blob_config;
+        if (!blob_config.deserialize(data, size))
+        {
+            return false;
+        }
+        config = blob_config;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * settings of builtin checks shared by all workers
+ */
+void SharedConfigManager::apply_algorithm_config(const AlgorithmConfig &config)
+{
+    std::map<OpenRASPCheckType, OpenRASPActionType> type_action_map;
+    std::map<std::string, std::string> buildin_action_map = CheckTypeTransfer::instance().get_buildin_action_map();
+    for (auto &item : buildin_action_map)
+    {
+        auto iter = config.buildin_actions.find(item.first);
+        type_action_map.insert({CheckTypeTransfer::instance().name_to_type(item.first),
+                                string_to_action(iter != config.buildin_actions.end() ? iter->second : item.second)});
+    }
+    set_buildin_check_action(type_action_map);
+    set_mysql_error_codes(config.mysql_error_codes);
+    set_sqlite_error_codes(config.sqlite_error_codes);
+    std::vector<std::string> pgsql_error_codes = config.pgsql_error_codes;
+    build_pg_error_array(pgsql_error_codes);
+    std::vector<std::string> ld_preload_env = config.ld_preload_env;
+    build_env_key_array(ld_preload_env);
+}
+
 long SharedConfigManager::get_log_max_backup()
 {
     if (rwlock != nullptr && rwlock->read_lock())
@@ -299,21 +436,25 @@ bool SharedConfigManager::write_weak_password_array_to_shm(const void *source, s
     if (rwlock != nullptr && rwlock->write_lock())
     {
         WriteUnLocker auto_unlocker(rwlock);
-        return shared_config_block->reset_weak_password_array(source, num);
+        if (shared_config_block->reset_weak_password_array(source, num) &&
+            verify_trie(shared_config_block->get_weak_password_array(), shared_config_block->get_weak_password_array_size()))
+        {
+            return true;
+        }
+        shared_config_block->reset_weak_password_array(source, 0);
     }
     return false;
 }
 
 bool SharedConfigManager::build_weak_password_array(std::vector<std::string> &weak_passwords)
 {
-    DoubleArrayTrie dat;
-    std::sort(weak_passwords.begin(), weak_passwords.end());
-    int error = dat.build(weak_passwords.size(), &weak_passwords, 0, 0);
-    if (error < 0 || dat.total_size() > SharedConfigBlock::WEAK_PASSWORD_ARRAY_MAX_SIZE)
+    CompactDoubleArrayTrie cdat;
+    int error = cdat.build(weak_passwords);
+    if (error < 0 || cdat.total_size() > SharedConfigBlock::WEAK_PASSWORD_ARRAY_MAX_SIZE)
     {
         return false;
     }
-    return write_weak_password_array_to_shm(dat.array(), dat.total_size());
+    return write_weak_password_array_to_shm(cdat.array(), cdat.total_size());
 }
 
 bool SharedConfigManager::build_weak_password_array(BaseReader *br)
@@ -344,15 +485,15 @@ bool SharedConfigManager::build_weak_password_array(BaseReader *br)
     return true;
 }
 
-bool SharedConfigManager::is_password_weak(std::string password)
+bool SharedConfigManager::is_password_weak(const std::string &password)
 {
-    DoubleArrayTrie dat;
+    CompactDoubleArrayTrie cdat;
+    CompactDoubleArrayTrie::value_type value = 0;
     if (rwlock != nullptr && rwlock->read_lock())
     {
         ReadUnLocker auto_unlocker(rwlock);
-        dat.set_array((void *)shared_config_block->get_weak_password_array(), shared_config_block->get_weak_password_array_size());
-        DoubleArrayTrie::result_pair_type result_pair = dat.match_search(password.c_str());
-        return result_pair.value != -1;
+        return cdat.set_array(shared_config_block->get_weak_password_array(), shared_config_block->get_weak_password_array_size()) &&
+               cdat.exact_match(password.c_str(), password.length(), value);
     }
     return false;
 }
@@ -395,100 +536,168 @@ bool SharedConfigManager::sqlite_error_code_exist(int64_t err_code)
     return false;
 }
 
-bool SharedConfigManager::write_pg_error_array_to_shm(const void *source, size_t num)
+bool SharedConfigManager::check_response_sampler(size_t slot, int interval, int burst)
 {
-    if (rwlock != nullptr && rwlock->write_lock())
+    if (shared_config_block == nullptr)
     {
-        WriteUnLocker auto_unlocker(rwlock);
-        return shared_config_block->reset_pg_error_array(source, num);
+        return false;
     }
-    return false;
+    Sampler *sampler = shared_config_block->get_response_sampler(slot);
+    return sampler != nullptr && sampler->check(interval, burst);
 }
 
-bool SharedConfigManager::build_pg_error_array(std::vector<std::string> &pg_errors)
+void SharedConfigManager::set_unregistered_check_types(uint64_t mask)
 {
-    DoubleArrayTrie dat;
-    std::sort(pg_errors.begin(), pg_errors.end());
-    int error = dat.build(pg_errors.size(), &pg_errors, 0, 0);
-    if (error < 0 || dat.total_size() > SharedConfigBlock::PG_ERROR_ARRAY_MAX_SIZE)
+    if (shared_config_block != nullptr)
     {
-        return false;
+        shared_config_block->set_unregistered_check_types(mask);
     }
-    return write_pg_error_array_to_shm(dat.array(), dat.total_size());
 }
 
-bool SharedConfigManager::build_pg_error_array(Isolate *isolate)
+uint64_t SharedConfigManager::get_unregistered_check_types()
+{
+    return shared_config_block != nullptr ? shared_config_block->get_unregistered_check_types() : 0;
+}
+
+void SharedConfigManager::add_plugin_time(int64_t micros)
 {
-    if (!isolate)
+    if (shared_config_block != nullptr && micros > 0)
     {
-        return false;
+        shared_config_block->add_plugin_time(micros, Sampler::coarse_time());
+    }
+}
+
+/**
+ * plugin microseconds spent by all workers in the last second
+ */
+int64_t SharedConfigManager::get_plugin_load()
+{
+    return shared_config_block != nullptr ? shared_config_block->get_plugin_load(Sampler::coarse_time()) : 0;
+}
+
+void SharedConfigManager::count_budget_degradation(int64_t sampled, int64_t skipped)
+{
+    if (shared_config_block != nullptr)
+    {
+        shared_config_block->count_budget_degradation(sampled, skipped);
     }
-    std::vector<std::string> pg_errs = extract_string_array(isolate, "RASP.algorithmConfig.sql_exception.pgsql.error_code", SharedConfigBlock::PGSQL_ERROR_CODE_MAX_SIZE);
-    return build_pg_error_array(pg_errs);
 }
 
-bool SharedConfigManager::pg_error_filtered(std::string error)
+int64_t SharedConfigManager::get_budget_degraded_requests()
+{
+    return shared_config_block != nullptr ? shared_config_block->get_budget_degraded_requests() : 0;
+}
+
+int64_t SharedConfigManager::get_budget_sampled_checks()
+{
+    return shared_config_block != nullptr ? shared_config_block->get_budget_sampled_checks() : 0;
+}
+
+int64_t SharedConfigManager::get_budget_skipped_checks()
+{
+    return shared_config_block != nullptr ? shared_config_block->get_budget_skipped_checks() : 0;
+}
+
+bool SharedConfigManager::get_dns_cache(const std::string &host, time_t now, std::vector<std::string> &ips)
 {
-    DoubleArrayTrie dat;
     if (rwlock != nullptr && rwlock->read_lock())
     {
         ReadUnLocker auto_unlocker(rwlock);
-        dat.set_array((void *)shared_config_block->get_pg_error_array(), shared_config_block->get_pg_error_array_size());
-        DoubleArrayTrie::result_pair_type result_pair = dat.match_search(error.c_str());
-        return result_pair.value != -1;
+        return shared_config_block->get_dns_cache(host, now, ips);
     }
     return false;
 }
 
-bool SharedConfigManager::write_env_key_array_to_shm(const void *source, size_t num)
+void SharedConfigManager::set_dns_cache(const std::string &host, const std::vector<std::string> &ips, time_t expire)
 {
     if (rwlock != nullptr && rwlock->write_lock())
     {
         WriteUnLocker auto_unlocker(rwlock);
-        return shared_config_block->reset_env_key_array(source, num);
+        shared_config_block->set_dns_cache(host, ips, expire);
+    }
+}
+
+bool SharedConfigManager::write_pg_error_array_to_shm(const void *source, size_t num)
+{
+    if (rwlock != nullptr && rwlock->write_lock())
+    {
+        WriteUnLocker auto_unlocker(rwlock);
+        if (shared_config_block->reset_pg_error_array(source, num) &&
+            verify_trie(shared_config_block->get_pg_error_array(), shared_config_block->get_pg_error_array_size()))
+        {
+            return true;
+        }
+        shared_config_block->reset_pg_error_array(source, 0);
     }
     return false;
 }
 
-bool SharedConfigManager::build_env_key_array(std::vector<std::string> &env_keys)
+bool SharedConfigManager::build_pg_error_array(std::vector<std::string> &pg_errors)
 {
-    DoubleArrayTrie dat;
-    std::sort(env_keys.begin(), env_keys.end());
-    int error = dat.build(env_keys.size(), &env_keys, 0, 0);
-    if (error < 0 || dat.total_size() > SharedConfigBlock::ENV_KEY_ARRAY_MAX_SIZE)
+    CompactDoubleArrayTrie cdat;
+    int error = cdat.build(pg_errors);
+    if (error < 0 || cdat.total_size() > SharedConfigBlock::PG_ERROR_ARRAY_MAX_SIZE)
     {
         return false;
     }
-    return write_env_key_array_to_shm(dat.array(), dat.total_size());
+    return write_pg_error_array_to_shm(cdat.array(), cdat.total_size());
+}
+
+bool SharedConfigManager::pg_error_filtered(const std::string &error)
+{
+    CompactDoubleArrayTrie cdat;
+    CompactDoubleArrayTrie::value_type value = 0;
+    if (rwlock != nullptr && rwlock->read_lock())
+    {
+        ReadUnLocker auto_unlocker(rwlock);
+        return cdat.set_array(shared_config_block->get_pg_error_array(), shared_config_block->get_pg_error_array_size()) &&
+               cdat.exact_match(error.c_str(), error.length(), value);
+    }
+    return false;
 }
 
-bool SharedConfigManager::build_env_key_array(Isolate *isolate)
+bool SharedConfigManager::write_env_key_array_to_shm(const void *source, size_t num)
 {
-    if (!isolate)
+    if (rwlock != nullptr && rwlock->write_lock())
+    {
+        WriteUnLocker auto_unlocker(rwlock);
+        if (shared_config_block->reset_env_key_array(source, num) &&
+            verify_trie(shared_config_block->get_env_key_array(), shared_config_block->get_env_key_array_size()))
+        {
+            return true;
+        }
+        shared_config_block->reset_env_key_array(source, 0);
+    }
+    return false;
+}
+
+bool SharedConfigManager::build_env_key_array(std::vector<std::string> &env_keys)
+{
+    CompactDoubleArrayTrie cdat;
+    int error = cdat.build(env_keys);
+    if (error < 0 || cdat.total_size() > SharedConfigBlock::ENV_KEY_ARRAY_MAX_SIZE)
     {
         return false;
     }
-    std::vector<std::string> pg_errs = extract_string_array(isolate, "RASP.algorithmConfig.webshell_ld_preload.env", SharedConfigBlock::WEBSHELL_ENV_KEY_MAX_SIZE);
-    return build_env_key_array(pg_errs);
+    return write_env_key_array_to_shm(cdat.array(), cdat.total_size());
 }
 
 bool SharedConfigManager::filter_env_key(const std::string &env)
 {
-    DoubleArrayTrie dat;
+    CompactDoubleArrayTrie cdat;
     bool found = false;
     if (rwlock != nullptr && rwlock->read_lock())
     {
         ReadUnLocker auto_unlocker(rwlock);
-        dat.set_array((void *)shared_config_block->get_env_key_array(), shared_config_block->get_env_key_array_size());
-        std::vector<DoubleArrayTrie::result_pair_type> result_pairs = dat.prefix_search(env.c_str());
-        for (DoubleArrayTrie::result_pair_type result_pair : result_pairs)
+        if (cdat.set_array(shared_config_block->get_env_key_array(), shared_config_block->get_env_key_array_size()))
         {
-            if (result_pair.value != -1 &&
-                result_pair.length <= env.length() - 1 &&
-                '=' == env[result_pair.length])
-            {
-                found = true;
-            }
+            cdat.common_prefix_search(env.c_str(), env.length(),
+                                      [&found, &env](CompactDoubleArrayTrie::value_type value, size_t length) {
+                                          if (length < env.length() && '=' == env[length])
+                                          {
+                                              found = true;
+                                          }
+                                      });
         }
     }
     return found;
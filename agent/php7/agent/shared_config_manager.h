@@ -24,6 +24,7 @@
 #include "utils/read_write_lock.h"
 #include "shared_config_block.h"
 #include "utils/base_reader.h"
+#include "openrasp_algorithm_config.h"
 
 namespace openrasp
 {
@@ -39,24 +40,29 @@ public:
   long get_config_last_update();
   bool set_config_last_update(long config_update_timestamp);
 
+  bool write_config_blob(const ConfigHolder &config, long config_time);
+  bool load_config_blob(ConfigHolder &config, long config_time);
+
+  bool write_algorithm_config(const AlgorithmConfig &config, uint64_t snapshot_timestamp);
+  bool load_algorithm_config(AlgorithmConfig &config, uint64_t snapshot_timestamp);
+  void apply_algorithm_config(const AlgorithmConfig &config);
+
   long get_log_max_backup();
   bool set_log_max_backup(long log_max_backup);
 
   long get_debug_level();
   bool set_debug_level(BaseReader *br);
 
-  dat_value get_check_type_white_bit_mask(std::string url);
+  dat_value get_check_type_white_bit_mask(const std::string &url);
   bool build_check_type_white_array(BaseReader *br);
 
   bool build_weak_password_array(BaseReader *br);
-  bool is_password_weak(std::string password);
+  bool is_password_weak(const std::string &password);
 
   bool build_pg_error_array(std::vector<std::string> &pg_errors);
-  bool build_pg_error_array(Isolate *isolate);
-  bool pg_error_filtered(std::string error);
+  bool pg_error_filtered(const std::string &error);
 
   bool build_env_key_array(std::vector<std::string> &env_keys);
-  bool build_env_key_array(Isolate *isolate);
   bool filter_env_key(const std::string &env);
 
   std::string get_rasp_id() const;
@@ -70,6 +76,21 @@ public:
   void set_sqlite_error_codes(std::vector<int64_t> error_codes);
   bool sqlite_error_code_exist(int64_t err_code);
 
+  bool check_response_sampler(size_t slot, int interval, int burst);
+
+  void set_unregistered_check_types(uint64_t mask);
+  uint64_t get_unregistered_check_types();
+
+  void add_plugin_time(int64_t micros);
+  int64_t get_plugin_load();
+  void count_budget_degradation(int64_t sampled, int64_t skipped);
+  int64_t get_budget_degraded_requests();
+  int64_t get_budget_sampled_checks();
+  int64_t get_budget_skipped_checks();
+
+  bool get_dns_cache(const std::string &host, time_t now, std::vector<std::string> &ips);
+  void set_dns_cache(const std::string &host, const std::vector<std::string> &ips, time_t expire);
+
 private:
   int meta_size;
   ReadWriteLock *rwlock;
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * DoubleArrayTrie vs CompactDoubleArrayTrie, build and lookup on a hook.white like url set.
+ *
+ * g++ -std=c++11 -O2 -I.. double_array_trie_bench.cc ../utils/compact_double_array_trie.cc ../utils/digest.cc -o dat_bench
+ * ./dat_bench [url_count] [lookup_count]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "utils/double_array_trie.h"
+#include "utils/compact_double_array_trie.h"
+
+using namespace openrasp;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    size_t url_count = argc > 1 ? atol(argv[1]) : 2000;
+    size_t lookup_count = argc > 2 ? atol(argv[2]) : 1000000;
+
+    std::mt19937 rng(20170101);
+    std::uniform_int_distribution<int> alpha('a', 'z');
+    std::uniform_int_distribution<int> len_dist(3, 12);
+    auto random_word = [&]() {
+        std::string word(len_dist(rng), 'a');
+        for (auto &c : word)
+        {
+            c = alpha(rng);
+        }
+        return word;
+    };
+
+    std::map<std::string, dat_value> white_map;
+    std::vector<std::string> hosts;
+    for (size_t i = 0; i < 50; ++i)
+    {
+        hosts.push_back(random_word() + ".example.com");
+    }
+    while (white_map.size() < url_count)
+    {
+        std::string url = hosts[rng() % hosts.size()] + "/" + random_word() + "/" + random_word();
+        white_map[url] = rng() & ((1 << 27) - 1);
+    }
+    std::vector<std::string> keys;
+    std::vector<dat_value> values;
+    std::vector<int64_t> compact_values;
+    for (auto &item : white_map)
+    {
+        keys.push_back(item.first);
+        values.push_back(item.second);
+        compact_values.push_back(item.second);
+    }
+    std::vector<std::string> queries;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        if (i % 2)
+        {
+            queries.push_back(keys[rng() % keys.size()] + "/index.php?id=" + std::to_string(i));
+        }
+        else
+        {
+            queries.push_back(hosts[rng() % hosts.size()] + "/" + random_word() + "/index.php");
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    DoubleArrayTrie dat;
+    if (dat.build(keys.size(), &keys, 0, &values) < 0)
+    {
+        std::cerr << "DoubleArrayTrie build failed" << std::endl;
+        return 1;
+    }
+    double dat_build = elapsed_ms(start);
+
+    start = std::chrono::steady_clock::now();
+    CompactDoubleArrayTrie cdat;
+    if (cdat.build(keys, &compact_values) < 0)
+    {
+        std::cerr << "CompactDoubleArrayTrie build failed" << std::endl;
+        return 1;
+    }
+    double cdat_build = elapsed_ms(start);
+
+    dat_value dat_mask = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookup_count; ++i)
+    {
+        const std::string &query = queries[i % queries.size()];
+        for (auto &result_pair : dat.prefix_search(query.c_str(), query.length()))
+        {
+            dat_mask ^= result_pair.value;
+        }
+    }
+    double dat_lookup = elapsed_ms(start);
+
+    dat_value cdat_mask = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookup_count; ++i)
+    {
+        const std::string &query = queries[i % queries.size()];
+        cdat.common_prefix_search(query.c_str(), query.length(),
+                                  [&cdat_mask](uint32_t value, size_t) { cdat_mask ^= value; });
+    }
+    double cdat_lookup = elapsed_ms(start);
+
+    std::cout << "keys: " << keys.size() << ", lookups: " << lookup_count << std::endl;
+    std::cout << "DoubleArrayTrie        build " << dat_build << " ms, size " << dat.total_size()
+              << " bytes, lookup " << dat_lookup << " ms" << std::endl;
+    std::cout << "CompactDoubleArrayTrie build " << cdat_build << " ms, size " << cdat.total_size()
+              << " bytes, lookup " << cdat_lookup << " ms" << std::endl;
+    std::cout << "results " << (dat_mask == cdat_mask ? "match" : "MISMATCH") << std::endl;
+    return dat_mask == cdat_mask ? 0 : 1;
+}
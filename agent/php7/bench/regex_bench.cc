@@ -0,0 +1,100 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * std::regex built per call (old utils/regex) vs cached CompiledRegex,
+ * on the patterns shipped by the official plugin and the agent defaults.
+ *
+ * g++ -std=c++11 -O2 -I.. regex_bench.cc ../utils/regex.cc -o regex_bench
+ * ./regex_bench [rounds]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+#include "utils/regex.h"
+
+using namespace openrasp;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Case
+{
+    const char *name;
+    const char *pattern;
+    bool search;
+    std::vector<std::string> inputs;
+};
+
+int main(int argc, char **argv)
+{
+    size_t rounds = argc > 1 ? atol(argv[1]) : 2000;
+    std::string long_param(2000, 'a');
+    long_param += "<script>";
+    std::vector<Case> cases = {
+        {"xss_userinput.filter_regex", "<![\\-\\[A-Za-z]|<([A-Za-z]{1,12})[\\/>\\x00-\\x20]", true,
+         {"hello world", "1 < 2 and 3 > 2", "<img src=x onerror=alert(1)>", "<!--", "id=12345&name=test", long_param}},
+        {"xss_echo.filter_regex", "<![\\\\-\\\\[A-Za-z]|<([A-Za-z]{1,12})[\\\\/ >]", true,
+         {"hello world", "<b>bold</b>", "plain text value with no tags at all", long_param}},
+        {"fileleak_scan.name", "\\.(git|svn|tar|gz|rar|zip|sql|log)$", true,
+         {"index.php", "backup.tar.gz", "www.zip", "db.sql", "readme.md", "access.log.1"}},
+        {"pdo sqlstate", "^SQLSTATE\\[[0-9A-Z]{5}\\] .*", true,
+         {"SQLSTATE[42S02]: Base table or view not found: 1146 Table 'test.t' doesn't exist", "connection refused"}},
+        {"pgsql error code", "^[0-9A-Z]{5}$", false,
+         {"42P01", "23505", "XX000", "hello"}},
+    };
+
+    bool consistent = true;
+    std::cout << "rounds: " << rounds << std::endl;
+    for (auto &item : cases)
+    {
+        size_t old_hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rounds; ++i)
+        {
+            for (auto &input : item.inputs)
+            {
+                const std::regex re(item.pattern);
+                old_hits += item.search ? std::regex_search(input.c_str(), re) : std::regex_match(input.c_str(), re);
+            }
+        }
+        double old_ms = elapsed_ms(start);
+
+        size_t new_hits = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rounds; ++i)
+        {
+            for (auto &input : item.inputs)
+            {
+                new_hits += item.search ? regex_search(input.c_str(), item.pattern) : regex_match(input.c_str(), item.pattern);
+            }
+        }
+        double new_ms = elapsed_ms(start);
+
+        consistent = consistent && old_hits == new_hits;
+        std::cout << item.name << ": std::regex " << old_ms << " ms, cached dfa " << new_ms << " ms"
+                  << (CompiledRegex(item.pattern).is_linear() ? "" : " (std::regex fallback)")
+                  << (old_hits == new_hits ? "" : " MISMATCH") << std::endl;
+    }
+    return consistent ? 0 : 1;
+}
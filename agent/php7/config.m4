@@ -536,6 +536,7 @@ int main() {
     hook/openrasp_echo.cc \
     openrasp_conf_holder.cc \
     openrasp_config_block.cc \
+    openrasp_algorithm_config.cc \
     openrasp_inject.cc \
     openrasp_log.cc \
     openrasp_error.cc \
@@ -549,7 +550,11 @@ int main() {
     utils/read_write_lock.cc \
     utils/string.cc \
     utils/digest.cc \
+    utils/blob.cc \
+    utils/compact_double_array_trie.cc \
     utils/regex.cc \
+    utils/aho_corasick.cc \
+    utils/sensitive_scanner.cc \
     utils/debug_trace.cc \
     utils/file.cc \    
     utils/time.cc \
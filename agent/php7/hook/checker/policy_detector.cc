@@ -33,7 +33,7 @@ bool PolicyDetector::pretreat() const
 
 CheckResult PolicyDetector::check()
 {
-    return (policy_material.policy_check(j)) ? kLog : kNoCache;
+    return (policy_material.policy_check()) ? kLog : kNoCache;
 }
 
 PolicyDetector::PolicyDetector(const openrasp::data::PolicyMaterial &policy_material)
@@ -49,13 +49,14 @@ void PolicyDetector::run()
     }
     if (kNoCache != check())
     {
-        policy_material.fill_json_with_params(j);
         log_policy();
     }
 }
 
 void PolicyDetector::log_policy()
 {
+    JsonReader j;
+    policy_material.fill_json_with_params(j);
     j.write_vector({"policy_params", "stack"}, format_debug_backtrace_arr());
     builtin_policy_info(j, policy_material.hash());
 }
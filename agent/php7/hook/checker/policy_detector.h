@@ -30,7 +30,6 @@ class PolicyDetector : public Detector
 {
 protected:
     const openrasp::data::PolicyMaterial &policy_material;
-    JsonReader j;
 
     virtual bool pretreat() const;
     virtual CheckResult check();
@@ -16,6 +16,7 @@
 
 #include "v8_detector.h"
 #include "openrasp_v8.h"
+#include <chrono>
 
 namespace openrasp
 {
@@ -41,10 +42,48 @@ CheckResult V8Detector::check()
     auto context = isolate->GetCurrentContext();
     auto params = v8::Object::New(isolate);
     v8_material.fill_object_2b_checked(isolate, params);
-    CheckResult check_result = Check(isolate, openrasp::NewV8String(isolate, CheckTypeTransfer::instance().type_to_name(v8_material.get_v8_check_type())), params, timeout);
+    alarmed = false;
+    auto start = std::chrono::steady_clock::now();
+    CheckResult check_result = Check(isolate, openrasp::NewV8String(isolate, CheckTypeTransfer::instance().type_to_name(v8_material.get_v8_check_type())), params, timeout, &alarmed);
+    OPENRASP_V8_G(plugin_micros) += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
     return check_result;
 }
 
+/**
+ * Answers a check whose identical material got a log or block alarm earlier in the request, the alarm is not logged again.
+ */
+bool V8Detector::recall(const std::string &lru_key)
+{
+    if (lru_key.empty())
+    {
+        return false;
+    }
+    auto &verdict_memo = OPENRASP_V8_G(verdict_memo);
+    auto it = verdict_memo.find(lru_key);
+    if (it == verdict_memo.end())
+    {
+        return false;
+    }
+    ++it->second.repeats;
+    if (kBlock == it->second.result && canBlock)
+    {
+        block_handle();
+    }
+    return true;
+}
+
+void V8Detector::memorize(const std::string &lru_key, CheckResult cr)
+{
+    auto &verdict_memo = OPENRASP_V8_G(verdict_memo);
+    if (lru_key.empty() ||
+        0 == OPENRASP_CONFIG(lru.max_size) ||
+        verdict_memo.size() >= max_memoized_verdicts)
+    {
+        return;
+    }
+    verdict_memo.emplace(lru_key, MemoizedVerdict{cr, 0});
+}
+
 V8Detector::V8Detector(const openrasp::data::V8Material &v8_material, openrasp::LRU<std::string, bool> &lru, openrasp::Isolate *isolate, int timeout, bool canBlock)
     : v8_material(v8_material), lru(lru), isolate(isolate), timeout(timeout), canBlock(canBlock)
 {
@@ -62,16 +101,25 @@ void V8Detector::run()
     {
         return;
     }
-    CheckResult cr = check();
-    if (kNoCache == cr)
+    if (recall(lru_ley))
     {
         return;
     }
-    else if (kCache == cr)
+    if (!plugin_budget_allows(v8_material.get_v8_check_type()))
+    {
+        return;
+    }
+    CheckResult cr = check();
+    if (kCache == cr)
     {
         lru.set(lru_ley, true);
+        return;
+    }
+    if (alarmed)
+    {
+        memorize(lru_ley, cr);
     }
-    else if (kBlock == cr && canBlock)
+    if (kBlock == cr && canBlock)
     {
         block_handle();
     }
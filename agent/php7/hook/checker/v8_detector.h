@@ -33,11 +33,18 @@ protected:
     openrasp::Isolate *isolate = nullptr;
     int timeout = 100;
     bool canBlock = true;
+    // the last check logged a log or block alarm
+    bool alarmed = false;
 
     virtual bool pretreat() const;
     virtual CheckResult check();
+    bool recall(const std::string &lru_key);
+    void memorize(const std::string &lru_key, CheckResult cr);
 
 public:
+    // per request, further alarming checks go to the plugin every time
+    static const size_t max_memoized_verdicts = 256;
+
     V8Detector(const openrasp::data::V8Material &v8_material, openrasp::LRU<std::string, bool> &lru, openrasp::Isolate *isolate, int timeout, bool canblock = true);
     virtual void run();
 };
@@ -42,7 +42,7 @@ OpenRASPCheckType PutenvObject::get_builtin_check_type() const
 {
     return WEBSHELL_ENV;
 }
-bool PutenvObject::builtin_check(JsonReader &j) const
+bool PutenvObject::builtin_check() const
 {
     return openrasp::scm->filter_env_key(std::string(Z_STRVAL_P(env)));
 }
@@ -107,7 +107,7 @@ void SqlConnectionObject::fill_json_with_params(JsonReader &j) const
     }
 }
 
-bool SqlConnectionObject::policy_check(JsonReader &j) const
+bool SqlConnectionObject::policy_check() const
 {
     return false;
 }
@@ -47,7 +47,7 @@ public:
 
     //policy
     virtual void fill_json_with_params(JsonReader &j) const;
-    virtual bool policy_check(JsonReader &j) const;
+    virtual bool policy_check() const;
     virtual ulong hash() const;
 
     //self
@@ -15,7 +15,7 @@
  */
 
 #include "ssrf_object.h"
-#include "utils/net.h"
+#include "openrasp_hook.h"
 
 namespace openrasp
 {
@@ -58,7 +58,7 @@ void SsrfObject::fill_object_2b_checked(Isolate *isolate, v8::Local<v8::Object>
     params->Set(context, openrasp::NewV8String(isolate, "function"), openrasp::NewV8String(isolate, function_name)).IsJust();
     params->Set(context, openrasp::NewV8String(isolate, "hostname"), openrasp::NewV8String(isolate, url.get_host())).IsJust();
     params->Set(context, openrasp::NewV8String(isolate, "port"), openrasp::NewV8String(isolate, url.get_port())).IsJust();
-    std::vector<std::string> ips = openrasp::lookup_host(url.get_host());
+    std::vector<std::string> ips = openrasp_lookup_host(url.get_host());
     auto ip_arr = v8::Array::New(isolate);
     for (int i = 0; i < ips.size(); ++i)
     {
@@ -15,7 +15,7 @@
  */
 
 #include "ssrf_redirect_object.h"
-#include "utils/net.h"
+#include "openrasp_hook.h"
 #include <curl/curl.h>
 
 namespace openrasp
@@ -64,7 +64,7 @@ void SsrfRedirectObject::fill_object_2b_checked(Isolate *isolate, v8::Local<v8::
     params->Set(context, openrasp::NewV8String(isolate, "url"), openrasp::NewV8String(isolate, Z_STRVAL_P(origin_url), Z_STRLEN_P(origin_url))).IsJust();
     params->Set(context, openrasp::NewV8String(isolate, "hostname"), openrasp::NewV8String(isolate, origin.get_host())).IsJust();
     params->Set(context, openrasp::NewV8String(isolate, "port"), openrasp::NewV8String(isolate, origin.get_port())).IsJust();
-    std::vector<std::string> origin_ips = openrasp::lookup_host(origin.get_host());
+    std::vector<std::string> origin_ips = openrasp_lookup_host(origin.get_host());
     auto ip_arr = v8::Array::New(isolate);
     for (int i = 0; i < origin_ips.size(); ++i)
     {
@@ -75,7 +75,7 @@ void SsrfRedirectObject::fill_object_2b_checked(Isolate *isolate, v8::Local<v8::
     params->Set(context, openrasp::NewV8String(isolate, "url2"), openrasp::NewV8String(isolate, Z_STRVAL_P(effective_url), Z_STRLEN_P(effective_url))).IsJust();
     params->Set(context, openrasp::NewV8String(isolate, "hostname2"), openrasp::NewV8String(isolate, effective.get_host())).IsJust();
     params->Set(context, openrasp::NewV8String(isolate, "port2"), openrasp::NewV8String(isolate, effective.get_port())).IsJust();
-    std::vector<std::string> effective_ips = openrasp::lookup_host(effective.get_host());
+    std::vector<std::string> effective_ips = openrasp_lookup_host(effective.get_host());
     auto ip2_arr = v8::Array::New(isolate);
     for (int i = 0; i < effective_ips.size(); ++i)
     {
@@ -42,7 +42,7 @@ OpenRASPCheckType XssUserInputObject::get_builtin_check_type() const
 {
     return XSS_USER_INPUT;
 }
-bool XssUserInputObject::builtin_check(JsonReader &j) const
+bool XssUserInputObject::builtin_check() const
 {
     //check in output handler
     return true;
@@ -31,6 +31,11 @@ static zend_free_op should_free;
 int echo_print_handler(zend_execute_data *execute_data)
 {
     const zend_op *opline = EX(opline);
+    // literals of the script, never part of the request
+    if (opline->op1_type == IS_CONST)
+    {
+        return ZEND_USER_OPCODE_DISPATCH;
+    }
 #if (PHP_MAJOR_VERSION == 7 && PHP_MINOR_VERSION < 3)
     zval *inc_filename = zend_get_zval_ptr(opline->op1_type, &opline->op1, execute_data, &should_free, BP_VAR_IS);
 #else
@@ -22,6 +22,7 @@
 #endif
 
 #include "utils/json_reader.h"
+#include <algorithm>
 
 namespace openrasp
 {
@@ -65,9 +66,34 @@ std::string Parameter::get_form_str() const
     return form_str.empty() ? "{}" : form_str;
 }
 
-std::string Parameter::get_json_str() const
+std::string Parameter::get_json_str()
 {
-    return json_str.empty() ? "{}" : json_str;
+    if (!has_json || 0 == json_len)
+    {
+        return "{}";
+    }
+    if (json_valid < 0)
+    {
+        JsonReader json_body(body.substr(0, json_len));
+        json_valid = json_body.has_error() ? 0 : 1;
+    }
+    return json_valid > 0 ? body.substr(0, json_len) : "{}";
+}
+
+bool Parameter::has_json_body() const
+{
+    return has_json && json_len > 0;
+}
+
+const char *Parameter::get_json_body(size_t &len) const
+{
+    len = has_json ? json_len : 0;
+    return body.data();
+}
+
+void Parameter::set_json_valid(bool valid)
+{
+    json_valid = valid ? 1 : 0;
 }
 
 std::string Parameter::get_multipart_str()
@@ -111,7 +137,7 @@ bool Parameter::fetch_fileinfo_by_tmpname(const std::string &tmpname, std::strin
 
 std::string Parameter::get_body() const
 {
-    return body_str;
+    return body.substr(0, body_str_len);
 }
 
 bool Parameter::get_initialized() const
@@ -127,44 +153,42 @@ void Parameter::set_initialized(bool initialized)
 void Parameter::clear()
 {
     form_str.clear();
-    json_str.clear();
-    body_str.clear();
+    body.clear();
+    body_complete = false;
+    body_str_len = 0;
+    json_len = 0;
+    has_json = false;
+    json_valid = -1;
     files.clear();
     multipart_str.clear();
     initialized = false;
 }
 
 //the functions below is different in PHP5 and PHP7
-void Parameter::update_body_str(size_t body_len)
+/**
+ * php://input is opened at most once more for every larger max_len, shorter reads are served from the buffer.
+ */
+const std::string &Parameter::fetch_body(size_t max_len)
 {
-    zend_string *body = nullptr;
-    if ((body = fetch_request_body(body_len)) != nullptr)
+    if (!body_complete && body.length() < max_len)
     {
-        if (ZSTR_LEN(body) > 0)
-        {
-            body_str = std::string(ZSTR_VAL(body), ZSTR_LEN(body));
-        }
-        zend_string_release(body);
+        zend_string *buf = fetch_request_body(max_len);
+        body.assign(ZSTR_VAL(buf), ZSTR_LEN(buf));
+        body_complete = ZSTR_LEN(buf) < max_len;
+        zend_string_release(buf);
     }
+    return body;
 }
 
-void Parameter::update_json_str()
+void Parameter::update_body_str(size_t body_len)
 {
-    json_str = "{}";
-    zend_string *body = nullptr;
-    if ((body = fetch_request_body(PHP_STREAM_COPY_ALL)) != nullptr)
-    {
-        if (ZSTR_LEN(body) > 0)
-        {
-            std::string body_str = std::string(ZSTR_VAL(body), ZSTR_LEN(body));
-            JsonReader json_body(body_str);
-            if (!json_body.has_error())
-            {
-                json_str = body_str;
-            }
-        }
-        zend_string_release(body);
-    }
+    body_str_len = std::min(fetch_body(body_len).length(), body_len);
+}
+
+void Parameter::update_json_str(size_t json_len)
+{
+    has_json = true;
+    this->json_len = std::min(fetch_body(json_len).length(), json_len);
 }
 
 void Parameter::update_form_str()
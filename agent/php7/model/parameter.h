@@ -47,9 +47,15 @@ public:
 private:
     /* data */
     std::string form_str;
-    std::string json_str;
-    std::string body_str;
     std::string multipart_str;
+    // leading bytes of php://input, read once and shared by every consumer of the body
+    std::string body;
+    bool body_complete = false;
+    size_t body_str_len = 0;
+    size_t json_len = 0;
+    bool has_json = false;
+    // -1 not parsed yet, 0 invalid, 1 valid
+    int json_valid = -1;
     std::map<std::vector<std::string>, MultipartFile> files;
     bool initialized = false;
 
@@ -58,12 +64,16 @@ public:
     virtual ~Parameter();
     bool get_initialized() const;
     void set_initialized(bool initialized);
+    const std::string &fetch_body(size_t max_len);
     void update_body_str(size_t body_len);
-    void update_json_str();
+    void update_json_str(size_t json_len);
     void update_form_str();
     void update_multipart_files();
     std::string get_form_str() const;
-    std::string get_json_str() const;
+    std::string get_json_str();
+    bool has_json_body() const;
+    const char *get_json_body(size_t &len) const;
+    void set_json_valid(bool valid);
     std::string get_multipart_str();
     std::string get_body() const;
     bool fetch_fileinfo_by_tmpname(const std::string &tmpname, std::string &name, std::string &filename) const;
@@ -18,7 +18,9 @@
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <cctype>
 #include "openrasp_content_type.h"
+#include "openrasp_utils.h"
 
 namespace openrasp
 {
@@ -26,6 +28,7 @@ namespace request
 {
 Request::Request(/* args */)
 {
+    ZVAL_UNDEF(&server);
 }
 
 Request::~Request()
@@ -81,18 +84,75 @@ std::string Request::get_document_root() const
     return document_root;
 }
 
-void Request::set_header(const std::map<std::string, std::string> &header)
+//the functions below is different in PHP5 and PHP7
+void Request::set_server(zval *server)
 {
-    this->header = header;
+    zval_ptr_dtor(&this->server);
+    ZVAL_UNDEF(&this->server);
+    if (nullptr != server && Z_TYPE_P(server) == IS_ARRAY)
+    {
+        // holding a reference makes later writes to $_SERVER separate from this snapshot
+        ZVAL_COPY(&this->server, server);
+    }
+    header.clear();
+    header_built = false;
 }
 
-std::map<std::string, std::string> Request::get_header() const
+const std::map<std::string, std::string> &Request::get_header()
 {
+    if (!header_built && Z_TYPE(server) == IS_ARRAY)
+    {
+        static const size_t max_header_keys = 1024;
+        zval *value = nullptr;
+        zend_string *key = nullptr;
+        ZEND_HASH_FOREACH_STR_KEY_VAL(Z_ARRVAL(server), key, value)
+        {
+            if (nullptr == key || Z_TYPE_P(value) != IS_STRING)
+            {
+                continue;
+            }
+            std::string server_key(ZSTR_VAL(key), ZSTR_LEN(key));
+            auto found = header_keys.find(server_key);
+            if (found == header_keys.end())
+            {
+                if (header_keys.size() >= max_header_keys)
+                {
+                    header_keys.clear();
+                }
+                found = header_keys.emplace(server_key, convert_to_header_key(ZSTR_VAL(key), ZSTR_LEN(key))).first;
+            }
+            if (!found->second.empty())
+            {
+                header[found->second] = std::string(Z_STRVAL_P(value), Z_STRLEN_P(value));
+            }
+        }
+        ZEND_HASH_FOREACH_END();
+    }
+    header_built = true;
     return header;
 }
 
-std::string Request::get_header(const std::string &key) const
+std::string Request::get_header(const std::string &key)
 {
+    if (!header_built && Z_TYPE(server) == IS_ARRAY)
+    {
+        // single lookups go straight to $_SERVER, e.g. content-type -> HTTP_CONTENT_TYPE
+        std::string server_key = "HTTP_" + key;
+        for (auto &ch : server_key)
+        {
+            ch = ch == '-' ? '_' : std::toupper(ch);
+        }
+        zval *value = zend_hash_str_find(Z_ARRVAL(server), server_key.c_str(), server_key.length());
+        if (nullptr == value && (key == "content-type" || key == "content-length"))
+        {
+            value = zend_hash_str_find(Z_ARRVAL(server), server_key.c_str() + 5, server_key.length() - 5);
+        }
+        if (nullptr != value && Z_TYPE_P(value) == IS_STRING)
+        {
+            return std::string(Z_STRVAL_P(value), Z_STRLEN_P(value));
+        }
+        return "";
+    }
     auto found = header.find(key);
     if (found != header.end())
     {
@@ -106,6 +166,11 @@ void Request::set_body_length(size_t body_len)
     this->body_len = body_len;
 }
 
+void Request::set_json_length(size_t json_len)
+{
+    this->json_len = json_len;
+}
+
 Parameter &Request::get_parameter()
 {
     if (!parameter.get_initialized())
@@ -115,7 +180,7 @@ Parameter &Request::get_parameter()
         switch (k_type)
         {
         case OpenRASPContentType::ContentType::cApplicationJson:
-            parameter.update_json_str();
+            parameter.update_json_str(json_len);
             break;
         case OpenRASPContentType::ContentType::cApplicationForm:
             parameter.update_form_str();
@@ -136,11 +201,15 @@ Parameter &Request::get_parameter()
 void Request::clear()
 {
     body_len = 0;
+    json_len = 0;
     id.clear();
     method.clear();
     remote_addr.clear();
     document_root.clear();
     header.clear();
+    header_built = false;
+    zval_ptr_dtor(&server);
+    ZVAL_UNDEF(&server);
     url.clear();
     parameter.clear();
 }
@@ -18,6 +18,7 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 #include "url.h"
 #include "parameter.h"
 
@@ -33,8 +34,14 @@ private:
     std::string method;
     std::string remote_addr;
     std::string document_root;
+    // $_SERVER of the current request, headers are only read from it when needed
+    zval server;
     std::map<std::string, std::string> header;
+    bool header_built = false;
+    // $_SERVER key -> header key, kept across requests
+    std::unordered_map<std::string, std::string> header_keys;
     size_t body_len;
+    size_t json_len;
 
     Parameter parameter;
 
@@ -51,10 +58,11 @@ public:
     std::string get_remote_addr() const;
     void set_document_root(const std::string &document_root);
     std::string get_document_root() const;
-    void set_header(const std::map<std::string, std::string> &header);
-    std::map<std::string, std::string> get_header() const;
-    std::string get_header(const std::string &key) const;
+    void set_server(zval *server);
+    const std::map<std::string, std::string> &get_header();
+    std::string get_header(const std::string &key);
     void set_body_length(size_t body_len);
+    void set_json_length(size_t json_len);
 
     Parameter &get_parameter();
 
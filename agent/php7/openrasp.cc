@@ -73,6 +73,10 @@ PHP_INI_ENTRY1("openrasp.remote_management_enable", "off", PHP_INI_SYSTEM, OnUpd
 PHP_INI_ENTRY1("openrasp.heartbeat_interval", "180", PHP_INI_SYSTEM, OnUpdateOpenraspHeartbeatInterval, &openrasp_ini.heartbeat_interval)
 PHP_INI_ENTRY1("openrasp.ssl_verifypeer", "off", PHP_INI_SYSTEM, OnUpdateOpenraspBool, &openrasp_ini.ssl_verifypeer)
 PHP_INI_ENTRY1("openrasp.iast_enable", "off", PHP_INI_SYSTEM, OnUpdateOpenraspBool, &openrasp_ini.iast_enable)
+PHP_INI_ENTRY1("openrasp.v8_max_old_space_size", "0", PHP_INI_SYSTEM, OnUpdateOpenraspUnsignedInt, &openrasp_ini.v8_max_old_space_size)
+PHP_INI_ENTRY1("openrasp.v8_max_semi_space_size", "0", PHP_INI_SYSTEM, OnUpdateOpenraspUnsignedInt, &openrasp_ini.v8_max_semi_space_size)
+PHP_INI_ENTRY1("openrasp.v8_lite_mode", "off", PHP_INI_SYSTEM, OnUpdateOpenraspBool, &openrasp_ini.v8_lite_mode)
+PHP_INI_ENTRY1("openrasp.v8_idle_trim_millis", "0", PHP_INI_SYSTEM, OnUpdateOpenraspUnsignedInt, &openrasp_ini.v8_idle_trim_millis)
 PHP_INI_END()
 
 PHP_GINIT_FUNCTION(openrasp)
@@ -266,31 +270,27 @@ PHP_RINIT_FUNCTION(openrasp)
             OPENRASP_G(request).set_remote_addr(fetch_outmost_string_from_ht(Z_ARRVAL_P(http_server), "REMOTE_ADDR"));
             OPENRASP_G(request).set_document_root(fetch_outmost_string_from_ht(Z_ARRVAL_P(http_server), "DOCUMENT_ROOT"));
 
-            std::map<std::string, std::string> header;
-            zval *value = nullptr;
-            zend_string *key = nullptr;
-            ZEND_HASH_FOREACH_STR_KEY_VAL(Z_ARRVAL_P(http_server), key, value)
-            {
-                std::string header_key = convert_to_header_key(ZSTR_VAL(key), ZSTR_LEN(key));
-                if (!header_key.empty() && Z_TYPE_P(value) == IS_STRING)
-                {
-                    header[header_key] = std::string(Z_STRVAL_P(value), Z_STRLEN_P(value));
-                }
-            }
-            ZEND_HASH_FOREACH_END();
-            OPENRASP_G(request).set_header(header);
+            OPENRASP_G(request).set_server(http_server);
         }
         int result;
         long config_last_update = openrasp::scm->get_config_last_update();
         if (config_last_update && config_last_update > OPENRASP_G(config).GetLatestUpdateTime())
         {
-            openrasp::JsonReader json_reader(get_complete_config_content(ConfigHolder::FromType::kJson));
-            if (OPENRASP_G(config).update(&json_reader))
+            if (openrasp::scm->load_config_blob(OPENRASP_G(config), config_last_update))
             {
                 OPENRASP_G(config).SetLatestUpdateTime(config_last_update);
             }
+            else
+            {
+                openrasp::JsonReader json_reader(get_complete_config_content(ConfigHolder::FromType::kJson));
+                if (OPENRASP_G(config).update(&json_reader))
+                {
+                    OPENRASP_G(config).SetLatestUpdateTime(config_last_update);
+                }
+            }
         }
         OPENRASP_G(request).set_body_length(OPENRASP_CONFIG(body.maxbytes));
+        OPENRASP_G(request).set_json_length(OPENRASP_CONFIG(body.json_maxbytes) > 0 ? OPENRASP_CONFIG(body.json_maxbytes) : PHP_STREAM_COPY_ALL);
         // openrasp_inject must be called before openrasp_log cuz of request_id
         result = PHP_RINIT(openrasp_inject)(INIT_FUNC_ARGS_PASSTHRU);
         result = PHP_RINIT(openrasp_log)(INIT_FUNC_ARGS_PASSTHRU);
@@ -325,9 +325,16 @@ PHP_RSHUTDOWN_FUNCTION(openrasp)
     {
         int result;
         hook_without_params(REQUEST_END);
+        result = PHP_RSHUTDOWN(openrasp_inject)(SHUTDOWN_FUNC_ARGS_PASSTHRU);
+        // the injected html is the last output, on php-fpm the client need not wait for the isolate work below,
+        // session and other modules shutting down later can no longer send output then
+        if (OPENRASP_CONFIG(response.finish_early) && openrasp::post_response_work_pending())
+        {
+            finish_fpm_request();
+        }
         result = PHP_RSHUTDOWN(openrasp_hook)(SHUTDOWN_FUNC_ARGS_PASSTHRU);
         result = PHP_RSHUTDOWN(openrasp_log)(SHUTDOWN_FUNC_ARGS_PASSTHRU);
-        result = PHP_RSHUTDOWN(openrasp_inject)(SHUTDOWN_FUNC_ARGS_PASSTHRU);
+        result = PHP_RSHUTDOWN(openrasp_v8)(SHUTDOWN_FUNC_ARGS_PASSTHRU);
         OPENRASP_G(request).clear();
     }
     return SUCCESS;
@@ -347,6 +354,21 @@ PHP_MINFO_FUNCTION(openrasp)
     php_info_print_table_row(2, "Commit Id", "");
 #endif
     php_info_print_table_row(2, "V8 Version", ZEND_TOSTR(V8_MAJOR_VERSION) "." ZEND_TOSTR(V8_MINOR_VERSION));
+    if (OPENRASP_V8_G(isolate))
+    {
+        v8::HeapStatistics stats;
+        OPENRASP_V8_G(isolate)->GetHeapStatistics(&stats);
+        php_info_print_table_row(2, "V8 Heap Used", std::to_string(stats.used_heap_size()).c_str());
+        php_info_print_table_row(2, "V8 Heap Total", std::to_string(stats.total_heap_size()).c_str());
+        php_info_print_table_row(2, "V8 Heap Limit", std::to_string(stats.heap_size_limit()).c_str());
+    }
+    if (openrasp::scm)
+    {
+        php_info_print_table_row(2, "Plugin Load (us/s)", std::to_string(openrasp::scm->get_plugin_load()).c_str());
+        php_info_print_table_row(2, "Plugin Budget Degraded Requests", std::to_string(openrasp::scm->get_budget_degraded_requests()).c_str());
+        php_info_print_table_row(2, "Plugin Budget Sampled Checks", std::to_string(openrasp::scm->get_budget_sampled_checks()).c_str());
+        php_info_print_table_row(2, "Plugin Budget Skipped Checks", std::to_string(openrasp::scm->get_budget_skipped_checks()).c_str());
+    }
 #ifdef HAVE_OPENRASP_REMOTE_MANAGER
     if (remote_active && openrasp::oam)
     {
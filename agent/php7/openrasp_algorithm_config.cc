@@ -0,0 +1,118 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "openrasp_algorithm_config.h"
+#include "utils/blob.h"
+
+namespace openrasp
+{
+
+const uint32_t AlgorithmConfig::blob_version = 2;
+
+const std::vector<std::string> AlgorithmConfig::default_callable_blacklist = {"system", "exec", "passthru", "proc_open", "shell_exec", "popen", "pcntl_exec", "assert"};
+const std::string AlgorithmConfig::default_filter_regex = "<![\\\\-\\\\[A-Za-z]|<([A-Za-z]{1,12})[\\\\/ >]";
+const int64_t AlgorithmConfig::default_min_param_length = 15;
+
+static void write_int64s(BlobWriter &writer, const std::vector<int64_t> &value)
+{
+    writer.write_int64(value.size());
+    for (int64_t item : value)
+    {
+        writer.write_int64(item);
+    }
+}
+
+static bool read_int64s(BlobReader &reader, std::vector<int64_t> &value)
+{
+    int64_t count = 0;
+    if (!reader.read_int64(count) || count < 0)
+    {
+        return false;
+    }
+    value.clear();
+    for (int64_t i = 0; i < count; ++i)
+    {
+        int64_t item = 0;
+        if (!reader.read_int64(item))
+        {
+            return false;
+        }
+        value.push_back(item);
+    }
+    return true;
+}
+
+void AlgorithmConfig::serialize(std::string &blob) const
+{
+    BlobWriter writer;
+    std::vector<std::string> action_names;
+    std::vector<std::string> actions;
+    for (auto &item : buildin_actions)
+    {
+        action_names.push_back(item.first);
+        actions.push_back(item.second);
+    }
+    writer.write_strings(action_names);
+    writer.write_strings(actions);
+    write_int64s(writer, mysql_error_codes);
+    write_int64s(writer, sqlite_error_codes);
+    writer.write_strings(pgsql_error_codes);
+    writer.write_strings(ld_preload_env);
+    writer.write_strings(callable_blacklist);
+    writer.write_string(echo_filter_regex);
+    writer.write_string(userinput_filter_regex);
+    writer.write_int64(userinput_min_length);
+    writer.write_string(data_leak_action);
+    writer.write_bool(data_leak_phone);
+    writer.write_bool(data_leak_identity_card);
+    writer.write_bool(data_leak_bank_card);
+    writer.write_int64(response_handlers);
+    blob = writer.data();
+}
+
+bool AlgorithmConfig::deserialize(const char *data, size_t size)
+{
+    BlobReader reader(data, size);
+    std::vector<std::string> action_names;
+    std::vector<std::string> actions;
+    if (!reader.read_strings(action_names) ||
+        !reader.read_strings(actions) ||
+        action_names.size() != actions.size())
+    {
+        return false;
+    }
+    buildin_actions.clear();
+    for (size_t i = 0; i < action_names.size(); ++i)
+    {
+        buildin_actions[action_names[i]] = actions[i];
+    }
+    return read_int64s(reader, mysql_error_codes) &&
+           read_int64s(reader, sqlite_error_codes) &&
+           reader.read_strings(pgsql_error_codes) &&
+           reader.read_strings(ld_preload_env) &&
+           reader.read_strings(callable_blacklist) &&
+           reader.read_string(echo_filter_regex) &&
+           reader.read_string(userinput_filter_regex) &&
+           reader.read_int64(userinput_min_length) &&
+           reader.read_string(data_leak_action) &&
+           reader.read_bool(data_leak_phone) &&
+           reader.read_bool(data_leak_identity_card) &&
+           reader.read_bool(data_leak_bank_card) &&
+           reader.read_int64(response_handlers) &&
+           reader.eof();
+}
+
+} // namespace openrasp
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+namespace openrasp
+{
+
+/**
+ * The parts of RASP.algorithmConfig read by native code, along with what the plugin sources
+ * tell about their handlers.
+ * It is exported once per snapshot and handed to workers through shared memory,
+ * fields keep their defaults when the plugin leaves them out or gives them the wrong type.
+ */
+class AlgorithmConfig
+{
+public:
+  /**
+   * bump it whenever fields are added to or removed from serialize/deserialize
+   */
+  static const uint32_t blob_version;
+
+  static const std::vector<std::string> default_callable_blacklist;
+  static const std::string default_filter_regex;
+  static const int64_t default_min_param_length;
+
+  void serialize(std::string &blob) const;
+  bool deserialize(const char *data, size_t size);
+
+public:
+  // builtin check name -> action, only for builtin checks the plugin gives an action
+  std::map<std::string, std::string> buildin_actions;
+  std::vector<int64_t> mysql_error_codes;
+  std::vector<int64_t> sqlite_error_codes;
+  std::vector<std::string> pgsql_error_codes;
+  std::vector<std::string> ld_preload_env;
+  std::vector<std::string> callable_blacklist = default_callable_blacklist;
+  std::string echo_filter_regex = default_filter_regex;
+  std::string userinput_filter_regex = default_filter_regex;
+  int64_t userinput_min_length = default_min_param_length;
+  // empty if the plugin has no response_dataLeak algorithm
+  std::string data_leak_action;
+  bool data_leak_phone = true;
+  bool data_leak_identity_card = true;
+  bool data_leak_bank_card = true;
+  // plugin.register('response') calls of all plugins, -1 if the sources do not tell
+  int64_t response_handlers = -1;
+};
+
+} // namespace openrasp
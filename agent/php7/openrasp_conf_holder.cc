@@ -20,6 +20,8 @@
 namespace openrasp
 {
 
+const uint32_t ConfigHolder::blob_version = 8;
+
 bool ConfigHolder::update(BaseReader *reader)
 {
   if (!reader || reader->has_error())
@@ -36,9 +38,44 @@ bool ConfigHolder::update(BaseReader *reader)
   lru.update(reader);
   decompile.update(reader);
   response.update(reader);
+  dns.update(reader);
   return true;
 }
 
+void ConfigHolder::serialize(std::string &blob) const
+{
+  BlobWriter writer;
+  plugin.serialize(writer);
+  log.serialize(writer);
+  syslog.serialize(writer);
+  block.serialize(writer);
+  inject.serialize(writer);
+  body.serialize(writer);
+  clientip.serialize(writer);
+  lru.serialize(writer);
+  decompile.serialize(writer);
+  response.serialize(writer);
+  dns.serialize(writer);
+  blob = writer.data();
+}
+
+bool ConfigHolder::deserialize(const char *data, size_t size)
+{
+  BlobReader reader(data, size);
+  return plugin.deserialize(reader) &&
+         log.deserialize(reader) &&
+         syslog.deserialize(reader) &&
+         block.deserialize(reader) &&
+         inject.deserialize(reader) &&
+         body.deserialize(reader) &&
+         clientip.deserialize(reader) &&
+         lru.deserialize(reader) &&
+         decompile.deserialize(reader) &&
+         response.deserialize(reader) &&
+         dns.deserialize(reader) &&
+         reader.eof();
+}
+
 long ConfigHolder::GetLatestUpdateTime() const
 {
   return latestUpdateTime;
@@ -35,9 +35,16 @@ public:
     kYaml
   };
 
+  /**
+   * bump it whenever fields are added to or removed from serialize/deserialize
+   */
+  static const uint32_t blob_version;
+
 public:
   ConfigHolder(){};
   bool update(BaseReader *reader);
+  void serialize(std::string &blob) const;
+  bool deserialize(const char *data, size_t size);
   long GetLatestUpdateTime() const;
   void SetLatestUpdateTime(long latestUpdateTime);
 
@@ -52,6 +59,7 @@ public:
   LruBlock lru;
   DecompileBlock decompile;
   ResponseBlock response;
+  DnsBlock dns;
 
 private:
   long latestUpdateTime = 0;
@@ -17,6 +17,7 @@
 #include "openrasp_config_block.h"
 #include "utils/regex.h"
 #include "utils/validator.h"
+#include <algorithm>
 #include "openrasp_v8.h"
 
 namespace openrasp
@@ -29,8 +30,43 @@ void PluginBlock::update(BaseReader *reader)
   timeout.millis = reader->fetch_int64({"plugin.timeout.millis"}, PluginBlock::default_timeout_millis, openrasp::g_zero_int64);
   maxstack = reader->fetch_int64({"plugin.maxstack"}, PluginBlock::default_maxstack, openrasp::ge_zero_int64);
   filter = reader->fetch_bool({"plugin.filter"}, true);
+  budget.millis = reader->fetch_int64({"plugin.budget.millis"}, 0, openrasp::ge_zero_int64);
+  budget.sample_interval = reader->fetch_int64({"plugin.budget.sample_interval"}, 10, openrasp::ge_zero_int64);
+  budget.skip_types = 0;
+  for (const auto &name : reader->fetch_object_keys({"plugin.budget.degrade"}))
+  {
+    OpenRASPCheckType check_type = CheckTypeTransfer::instance().name_to_type(name);
+    if (check_type != INVALID_TYPE &&
+        reader->fetch_string({"plugin.budget.degrade", name}, "sample") == "skip")
+    {
+      budget.skip_types |= (1LL << check_type);
+    }
+  }
+  budget.overload_percent = reader->fetch_int64({"plugin.budget.overload_percent"}, 50, openrasp::ge_zero_int64);
 };
 
+void PluginBlock::serialize(BlobWriter &writer) const
+{
+  writer.write_int64(timeout.millis);
+  writer.write_int64(maxstack);
+  writer.write_bool(filter);
+  writer.write_int64(budget.millis);
+  writer.write_int64(budget.sample_interval);
+  writer.write_int64(budget.skip_types);
+  writer.write_int64(budget.overload_percent);
+}
+
+bool PluginBlock::deserialize(BlobReader &reader)
+{
+  return reader.read_int64(timeout.millis) &&
+         reader.read_int64(maxstack) &&
+         reader.read_bool(filter) &&
+         reader.read_int64(budget.millis) &&
+         reader.read_int64(budget.sample_interval) &&
+         reader.read_int64(budget.skip_types) &&
+         reader.read_int64(budget.overload_percent);
+}
+
 const int64_t LogBlock::default_maxburst = 100;
 
 void LogBlock::update(BaseReader *reader)
@@ -38,6 +74,16 @@ void LogBlock::update(BaseReader *reader)
   maxburst = reader->fetch_int64({"log.maxburst"}, LogBlock::default_maxburst, openrasp::ge_zero_int64);
 };
 
+void LogBlock::serialize(BlobWriter &writer) const
+{
+  writer.write_int64(maxburst);
+}
+
+bool LogBlock::deserialize(BlobReader &reader)
+{
+  return reader.read_int64(maxburst);
+}
+
 const std::string SyslogBlock::default_tag = "OpenRASP";
 const int64_t SyslogBlock::default_facility = 1;
 const int64_t SyslogBlock::default_connection_timeout = 50;
@@ -58,6 +104,28 @@ void SyslogBlock::update(BaseReader *reader)
   reconnect_interval = reader->fetch_int64({"syslog.reconnect_interval"}, SyslogBlock::default_reconnect_interval, openrasp::g_zero_int64);
 };
 
+void SyslogBlock::serialize(BlobWriter &writer) const
+{
+  writer.write_string(tag);
+  writer.write_string(url);
+  writer.write_int64(facility);
+  writer.write_bool(enable);
+  writer.write_int64(connection_timeout);
+  writer.write_int64(read_timeout);
+  writer.write_int64(reconnect_interval);
+}
+
+bool SyslogBlock::deserialize(BlobReader &reader)
+{
+  return reader.read_string(tag) &&
+         reader.read_string(url) &&
+         reader.read_int64(facility) &&
+         reader.read_bool(enable) &&
+         reader.read_int64(connection_timeout) &&
+         reader.read_int64(read_timeout) &&
+         reader.read_int64(reconnect_interval);
+}
+
 const int64_t BlockBlock::default_status_code = 302;
 
 void BlockBlock::update(BaseReader *reader)
@@ -69,6 +137,24 @@ void BlockBlock::update(BaseReader *reader)
   content_html = reader->fetch_string({"block.content_html"}, std::string(R"(</script><script>location.href="https://rasp.baidu.com/blocked2/?request_id=%request_id%"</script>)"));
 };
 
+void BlockBlock::serialize(BlobWriter &writer) const
+{
+  writer.write_int64(status_code);
+  writer.write_string(redirect_url);
+  writer.write_string(content_json);
+  writer.write_string(content_xml);
+  writer.write_string(content_html);
+}
+
+bool BlockBlock::deserialize(BlobReader &reader)
+{
+  return reader.read_int64(status_code) &&
+         reader.read_string(redirect_url) &&
+         reader.read_string(content_json) &&
+         reader.read_string(content_xml) &&
+         reader.read_string(content_html);
+}
+
 void InjectBlock::update(BaseReader *reader)
 {
   urlprefix = reader->fetch_string({"inject.urlprefix"});
@@ -87,18 +173,53 @@ void InjectBlock::update(BaseReader *reader)
   }
 };
 
+void InjectBlock::serialize(BlobWriter &writer) const
+{
+  writer.write_string(urlprefix);
+  writer.write_strings(headers);
+}
+
+bool InjectBlock::deserialize(BlobReader &reader)
+{
+  return reader.read_string(urlprefix) &&
+         reader.read_strings(headers);
+}
+
 const int64_t BodyBlock::default_maxbytes = 4 * 1024;
 
 void BodyBlock::update(BaseReader *reader)
 {
   maxbytes = reader->fetch_int64({"body.maxbytes"}, BodyBlock::default_maxbytes, openrasp::ge_zero_int64);
+  json_maxbytes = reader->fetch_int64({"body.json_maxbytes"}, 0, openrasp::ge_zero_int64);
 };
 
+void BodyBlock::serialize(BlobWriter &writer) const
+{
+  writer.write_int64(maxbytes);
+  writer.write_int64(json_maxbytes);
+}
+
+bool BodyBlock::deserialize(BlobReader &reader)
+{
+  return reader.read_int64(maxbytes) &&
+         reader.read_int64(json_maxbytes);
+}
+
 void ClientipBlock::update(BaseReader *reader)
 {
   header = reader->fetch_string({"clientip.header"}, std::string("ClientIP"));
 };
 
+void ClientipBlock::serialize(BlobWriter &writer) const
+{
+  writer.write_string(header);
+}
+
+bool ClientipBlock::deserialize(BlobReader &reader)
+{
+  return reader.read_string(header);
+}
+
 const int64_t LruBlock::default_max_size = 1024;
 
 void LruBlock::update(BaseReader *reader)
@@ -106,11 +227,33 @@ void LruBlock::update(BaseReader *reader)
   max_size = reader->fetch_int64({"lru.max_size"}, LruBlock::default_max_size, openrasp::ge_zero_int64);
 };
 
+void LruBlock::serialize(BlobWriter &writer) const
+{
+  writer.write_int64(max_size);
+}
+
+bool LruBlock::deserialize(BlobReader &reader)
+{
+  return reader.read_int64(max_size);
+}
+
 void DecompileBlock::update(BaseReader *reader)
 {
   enable = reader->fetch_bool({"decompile.enable"}, false);
 };
 
+void DecompileBlock::serialize(BlobWriter &writer) const
+{
+  writer.write_bool(enable);
+}
+
+bool DecompileBlock::deserialize(BlobReader &reader)
+{
+  return reader.read_bool(enable);
+}
+
+const size_t ResponseBlock::max_sampler_prefixes = 16;
+
 void ResponseBlock::update(BaseReader *reader)
 {
   sampler_interval = reader->fetch_int64({"response.sampler_interval"}, 60,
@@ -118,6 +261,99 @@ void ResponseBlock::update(BaseReader *reader)
                                            return openrasp::limit_int64(value, 60, true);
                                          });
   sampler_burst = reader->fetch_int64({"response.sampler_burst"}, 5);
+  std::vector<std::string> prefixes = reader->fetch_object_keys({"response.sampler_prefix"});
+  std::stable_sort(prefixes.begin(), prefixes.end(),
+                   [](const std::string &a, const std::string &b) { return a.length() > b.length(); });
+  sampler_prefixes.clear();
+  sampler_prefix_bursts.clear();
+  for (const auto &prefix : prefixes)
+  {
+    if (prefix.empty() || sampler_prefixes.size() >= max_sampler_prefixes)
+    {
+      continue;
+    }
+    sampler_prefixes.push_back(prefix);
+    sampler_prefix_bursts.push_back(reader->fetch_int64({"response.sampler_prefix", prefix}, sampler_burst, openrasp::ge_zero_int64));
+  }
+  chunk_size = reader->fetch_int64({"response.chunk_size"}, 0, openrasp::ge_zero_int64);
+  finish_early = reader->fetch_bool({"response.finish_early"}, false);
+};
+
+size_t ResponseBlock::sampler_slot(const std::string &request_uri) const
+{
+  for (size_t i = 0; i < sampler_prefixes.size(); ++i)
+  {
+    if (0 == request_uri.compare(0, sampler_prefixes[i].length(), sampler_prefixes[i]))
+    {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+int ResponseBlock::sampler_slot_burst(size_t slot) const
+{
+  if (slot > 0 && slot <= sampler_prefix_bursts.size())
+  {
+    return sampler_prefix_bursts[slot - 1];
+  }
+  return sampler_burst;
+}
+
+void ResponseBlock::serialize(BlobWriter &writer) const
+{
+  writer.write_int64(sampler_interval);
+  writer.write_int64(sampler_burst);
+  writer.write_strings(sampler_prefixes);
+  for (int64_t burst : sampler_prefix_bursts)
+  {
+    writer.write_int64(burst);
+  }
+  writer.write_int64(chunk_size);
+  writer.write_bool(finish_early);
+}
+
+bool ResponseBlock::deserialize(BlobReader &reader)
+{
+  int64_t interval = 0;
+  int64_t burst = 0;
+  if (!reader.read_int64(interval) || !reader.read_int64(burst) || !reader.read_strings(sampler_prefixes))
+  {
+    return false;
+  }
+  sampler_prefix_bursts.resize(sampler_prefixes.size());
+  for (int64_t &prefix_burst : sampler_prefix_bursts)
+  {
+    if (!reader.read_int64(prefix_burst))
+    {
+      return false;
+    }
+  }
+  if (!reader.read_int64(chunk_size) || !reader.read_bool(finish_early))
+  {
+    return false;
+  }
+  sampler_interval = interval;
+  sampler_burst = burst;
+  return true;
+}
+
+void DnsBlock::update(BaseReader *reader)
+{
+  cache_ttl = reader->fetch_int64({"dns.cache_ttl"}, 60, openrasp::ge_zero_int64);
+  negative_ttl = reader->fetch_int64({"dns.negative_ttl"}, 5, openrasp::ge_zero_int64);
 };
 
-} // namespace openrasp
\ No newline at end of file
+void DnsBlock::serialize(BlobWriter &writer) const
+{
+  writer.write_int64(cache_ttl);
+  writer.write_int64(negative_ttl);
+}
+
+bool DnsBlock::deserialize(BlobReader &reader)
+{
+  return reader.read_int64(cache_ttl) &&
+         reader.read_int64(negative_ttl);
+}
+
+} // namespace openrasp
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <memory>
 #include "utils/base_reader.h"
+#include "utils/blob.h"
 #include "php/header.h"
 
 namespace openrasp
@@ -44,7 +45,20 @@ public:
   } timeout;
   int64_t maxstack = 100;
   bool filter = true;
+  struct
+  {
+    // plugin time a request may spend in total, 0 for no limit
+    int64_t millis = 0;
+    // over budget, one check in sample_interval still runs, 0 to run none
+    int64_t sample_interval = 10;
+    // bits of check types that run none over budget instead of sampling
+    int64_t skip_types = 0;
+    // share of host cpus taken by plugins, in percent, above which every budget shrinks, 0 to disable
+    int64_t overload_percent = 50;
+  } budget;
   void update(BaseReader *reader);
+  void serialize(BlobWriter &writer) const;
+  bool deserialize(BlobReader &reader);
 };
 
 // log
@@ -54,6 +68,8 @@ public:
   const static int64_t default_maxburst;
   int64_t maxburst = 100;
   void update(BaseReader *reader);
+  void serialize(BlobWriter &writer) const;
+  bool deserialize(BlobReader &reader);
 };
 
 class SyslogBlock
@@ -72,6 +88,8 @@ public:
   int64_t read_timeout = 10;
   int64_t reconnect_interval = 300;
   void update(BaseReader *reader);
+  void serialize(BlobWriter &writer) const;
+  bool deserialize(BlobReader &reader);
 };
 
 // block repsonse
@@ -85,6 +103,8 @@ public:
   string content_xml = R"(<?xml version="1.0"?><doc><error>true</error><reason>Request blocked by OpenRASP</reason><request_id>%request_id%</request_id></doc>)";
   string content_html = R"(</script><script>location.href="https://rasp.baidu.com/blocked2/?request_id=%request_id%"</script>)";
   void update(BaseReader *reader);
+  void serialize(BlobWriter &writer) const;
+  bool deserialize(BlobReader &reader);
 };
 // others
 class InjectBlock
@@ -93,6 +113,8 @@ public:
   string urlprefix;
   vector<string> headers;
   void update(BaseReader *reader);
+  void serialize(BlobWriter &writer) const;
+  bool deserialize(BlobReader &reader);
 };
 
 class BodyBlock
@@ -100,7 +122,11 @@ class BodyBlock
 public:
   const static int64_t default_maxbytes;
   int64_t maxbytes = 4 * 1024;
+  // 0 for the whole json body
+  int64_t json_maxbytes = 0;
   void update(BaseReader *reader);
+  void serialize(BlobWriter &writer) const;
+  bool deserialize(BlobReader &reader);
 };
 
 class ClientipBlock
@@ -108,6 +134,8 @@ class ClientipBlock
 public:
   string header;
   void update(BaseReader *reader);
+  void serialize(BlobWriter &writer) const;
+  bool deserialize(BlobReader &reader);
 };
 
 class LruBlock
@@ -116,6 +144,8 @@ public:
   const static int64_t default_max_size;
   int64_t max_size = 1024;
   void update(BaseReader *reader);
+  void serialize(BlobWriter &writer) const;
+  bool deserialize(BlobReader &reader);
 };
 
 class DecompileBlock
@@ -123,14 +153,42 @@ class DecompileBlock
 public:
   bool enable = false;
   void update(BaseReader *reader);
+  void serialize(BlobWriter &writer) const;
+  bool deserialize(BlobReader &reader);
 };
 
 class ResponseBlock
 {
 public:
+  const static size_t max_sampler_prefixes;
   int sampler_interval;
   int sampler_burst;
+  // per url prefix burst, longest prefix first
+  std::vector<std::string> sampler_prefixes;
+  std::vector<int64_t> sampler_prefix_bursts;
+  int64_t chunk_size;
+  // on php-fpm, end the request after the openrasp shutdown when isolate work follows
+  bool finish_early = false;
+  /**
+   * @return 1 + index of the longest prefix of request_uri, 0 if none matches
+   */
+  size_t sampler_slot(const std::string &request_uri) const;
+  int sampler_slot_burst(size_t slot) const;
+  void update(BaseReader *reader);
+  void serialize(BlobWriter &writer) const;
+  bool deserialize(BlobReader &reader);
+};
+
+class DnsBlock
+{
+public:
+  // seconds resolved addresses are shared between workers, 0 to disable
+  int64_t cache_ttl = 60;
+  // seconds hosts found not to exist are shared between workers, 0 to disable
+  int64_t negative_ttl = 5;
   void update(BaseReader *reader);
+  void serialize(BlobWriter &writer) const;
+  bool deserialize(BlobReader &reader);
 };
 
 } // namespace openrasp
\ No newline at end of file
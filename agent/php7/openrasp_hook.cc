@@ -24,6 +24,7 @@
 #include <map>
 #include <algorithm>
 #include "agent/shared_config_manager.h"
+#include "utils/net.h"
 #include <unordered_map>
 #include "openrasp_content_type.h"
 #include "openrasp_check_type.h"
@@ -106,7 +107,7 @@ bool openrasp_check_type_ignored(OpenRASPCheckType check_type)
     return false;
 }
 
-std::string openrasp_real_path(const char *filename, int length, bool use_include_path, uint32_t w_op)
+static std::string resolve_real_path(const char *filename, int length, bool use_include_path, uint32_t w_op)
 {
     std::string result;
     static const std::unordered_map<std::string, uint32_t> opMap = {
@@ -219,6 +220,80 @@ std::string openrasp_real_path(const char *filename, int length, bool use_includ
     return result;
 }
 
+/**
+ * Memoized per request, template engines touch the same files many times.
+ * Only resolved paths are kept, a miss may turn into a hit once the file is created.
+ * An entry is used only while PHP's realpath cache still holds the resolved path, PHP drops that cache
+ * on unlink, rename, rmdir and clearstatcache(true), and lets it expire after realpath_cache_ttl.
+ */
+std::string openrasp_real_path(const char *filename, int length, bool use_include_path, uint32_t w_op)
+{
+    static const size_t max_memo_size = 4096;
+    std::string key;
+    key.append(std::to_string(w_op)).push_back('\0');
+    if (OPENRASP_CONFIG(plugin.filter))
+    {
+        // open_basedir may be tightened with ini_set in the middle of a request
+        const char *open_basedir = PG(open_basedir);
+        key.append("filter:").append(open_basedir ? open_basedir : "");
+    }
+    key.push_back('\0');
+    if (nullptr == determine_scheme_pos(filename) && !IS_ABSOLUTE_PATH(filename, length))
+    {
+        // relative paths depend on the working directory and, with include_path, on the executing script
+        char cwd[MAXPATHLEN];
+        if (nullptr == VCWD_GETCWD(cwd, MAXPATHLEN))
+        {
+            return resolve_real_path(filename, length, use_include_path, w_op);
+        }
+        key.append(cwd).push_back('\0');
+        if (use_include_path)
+        {
+            const char *include_path = PG(include_path);
+            key.append(include_path ? include_path : "").push_back('\0');
+            key.append(zend_get_executed_filename()).push_back('\0');
+        }
+    }
+    key.append(filename, length);
+    auto &memo = OPENRASP_HOOK_G(real_path_memo);
+    auto found = memo.find(key);
+    if (found != memo.end())
+    {
+        if (nullptr != realpath_cache_lookup(found->second.c_str(), found->second.length(), time(nullptr)))
+        {
+            return found->second;
+        }
+        memo.erase(found);
+    }
+    std::string result = resolve_real_path(filename, length, use_include_path, w_op);
+    if (!result.empty() && memo.size() < max_memo_size &&
+        nullptr != realpath_cache_lookup(result.c_str(), result.length(), time(nullptr)))
+    {
+        memo.emplace(std::move(key), result);
+    }
+    return result;
+}
+
+std::vector<std::string> openrasp_lookup_host(const std::string &host)
+{
+    std::vector<std::string> ips;
+    const auto &dns = OPENRASP_CONFIG(dns);
+    bool use_cache = openrasp::scm != nullptr && (dns.cache_ttl > 0 || dns.negative_ttl > 0);
+    time_t now = time(nullptr);
+    if (use_cache && openrasp::scm->get_dns_cache(host, now, ips))
+    {
+        return ips;
+    }
+    // resolver failures are not cached, the next check asks again
+    bool answered = openrasp::lookup_host(host, ips);
+    int64_t ttl = !answered ? 0 : (ips.empty() ? dns.negative_ttl : dns.cache_ttl);
+    if (use_cache && ttl > 0)
+    {
+        openrasp::scm->set_dns_cache(host, ips, now + ttl);
+    }
+    return ips;
+}
+
 static std::string resolve_request_id(std::string str)
 {
     static std::string placeholder = "%request_id%";
@@ -401,6 +476,8 @@ PHP_RINIT_FUNCTION(openrasp_hook)
                 OPENRASP_HOOK_G(check_type_white_bit_mask) |= (1 << check_type);
             }
         }
+        // no plugin handler would run for these
+        OPENRASP_HOOK_G(check_type_white_bit_mask) |= openrasp::scm->get_unregistered_check_types();
     }
     OPENRASP_HOOK_G(origin_pg_error_verbos) = -1;
     update_zend_ref_items();
@@ -410,6 +487,7 @@ PHP_RINIT_FUNCTION(openrasp_hook)
 PHP_RSHUTDOWN_FUNCTION(openrasp_hook)
 {
     OPENRASP_HOOK_G(zend_ref_items).clear();
+    OPENRASP_HOOK_G(real_path_memo).clear();
     return SUCCESS;
 }
 
@@ -65,6 +65,7 @@ extern "C"
 }
 #endif
 #include <string>
+#include <vector>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -281,6 +282,7 @@ long origin_pg_error_verbos;
 std::unordered_set<std::string> callable_blacklist;
 std::string echo_filter_regex;
 std::unordered_map<uintptr_t, const openrasp::request::ZendRefItem> zend_ref_items;
+std::unordered_map<std::string, std::string> real_path_memo;
 ZEND_END_MODULE_GLOBALS(openrasp_hook)
 
 ZEND_EXTERN_MODULE_GLOBALS(openrasp_hook);
@@ -303,6 +305,10 @@ PHP_RSHUTDOWN_FUNCTION(openrasp_hook);
 typedef void (*fill_param_t)(HashTable *ht);
 
 std::string openrasp_real_path(const char *filename, int length, bool use_include_path, uint32_t w_op);
+/**
+ * addresses of host, shared between workers for dns.cache_ttl seconds (dns.negative_ttl if unresolved)
+ */
+std::vector<std::string> openrasp_lookup_host(const std::string &host);
 
 void register_hook_handler(hook_handler_t hook_handler, OpenRASPCheckType type, PriorityType::HookPriority hp = PriorityType::pNormal);
 
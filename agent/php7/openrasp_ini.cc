@@ -96,6 +96,17 @@ ZEND_INI_MH(OnUpdateOpenraspHeartbeatInterval)
     return SUCCESS;
 }
 
+ZEND_INI_MH(OnUpdateOpenraspUnsignedInt)
+{
+    long tmp = zend_atol(new_value->val, new_value->len);
+    if (tmp < 0 || tmp > std::numeric_limits<unsigned int>::max())
+    {
+        return FAILURE;
+    }
+    *reinterpret_cast<unsigned int *>(mh_arg1) = tmp;
+    return SUCCESS;
+}
+
 bool strtobool(const char *str, int len)
 {
     return atoi(str);
@@ -23,6 +23,7 @@
 ZEND_INI_MH(OnUpdateOpenraspCString);
 ZEND_INI_MH(OnUpdateOpenraspBool);
 ZEND_INI_MH(OnUpdateOpenraspHeartbeatInterval);
+ZEND_INI_MH(OnUpdateOpenraspUnsignedInt);
 
 class Openrasp_ini
 {
@@ -37,6 +38,13 @@ public:
   bool remote_management_enable = true;
   bool ssl_verifypeer = false;
   bool iast_enable = false;
+  // per isolate heap limits in MB, 0 for the v8 defaults
+  unsigned int v8_max_old_space_size = 0;
+  unsigned int v8_max_semi_space_size = 0;
+  // interpreter only, smaller heap
+  bool v8_lite_mode = false;
+  // trims the isolate heap once per quiet period, when two requests in a row each followed this many idle milliseconds, 0 to disable
+  unsigned int v8_idle_trim_millis = 0;
 
   static const char *APPID_REGEX;
   static const char *APPSECRET_REGEX;
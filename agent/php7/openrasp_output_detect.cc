@@ -24,57 +24,105 @@
 #include "hook/data/xss_userinput_object.h"
 #include "hook/data/response_object.h"
 #include "openrasp_content_type.h"
-#include "utils/sampler.h"
-#include <mutex>
+#include "utils/aho_corasick.h"
+#include <algorithm>
 
 using namespace openrasp;
 
 ZEND_DECLARE_MODULE_GLOBALS(openrasp_output_detect)
 
-Sampler sampler;
-std::mutex mtx;
-
 static void _check_header_content_type_if_html(void *data, void *arg);
-static int _detect_param_occur_in_html_output(const char *param, OpenRASPActionType action);
+static bool _reflection_scan_start();
+static void _reflection_scan(const char *content, size_t content_length);
+static int _reflection_report();
+static int _detect_param_occur_in_html_output(const char *content, size_t content_length, OpenRASPActionType action);
 static bool _gpc_parameter_filter(const zval *param);
 static const char *get_content_type();
 static int check_xss(const char *content, size_t content_length, const char *content_type);
+static int check_xss_chunk(const char *content, size_t content_length);
 static void check_sensitive_content(const char *content, size_t content_length, const char *content_type);
+static void check_sensitive_content_chunk(const char *content, size_t content_length, const char *content_type);
 
 static php_output_handler *openrasp_output_handler_init(const char *handler_name, size_t handler_name_len, size_t chunk_size, int flags);
-static void openrasp_clean_output_start(const char *name, size_t name_len);
+static void openrasp_clean_output_start(const char *name, size_t name_len, size_t chunk_size);
 static int openrasp_output_handler(void **nothing, php_output_context *output_context);
+static int openrasp_output_stream(php_output_context *output_context, const char *content, size_t content_length);
+static void openrasp_output_pass(php_output_context *output_context);
+
+// sensitive data split by a chunk boundary is still seen as a whole
+static const size_t sensitive_overlap = 64;
 
 static int openrasp_output_handler(void **nothing, php_output_context *output_context)
 {
     OUTPUT_G(output_detect) = true;
     int status = FAILURE;
+    auto content = output_context->in.data;
+    auto content_length = strnlen(output_context->in.data, output_context->in.size);
     if ((output_context->op & PHP_OUTPUT_HANDLER_START) &&
         (output_context->op & PHP_OUTPUT_HANDLER_FINAL))
     {
-        auto content = output_context->in.data;
-        auto content_length = strnlen(output_context->in.data, output_context->in.size);
         auto content_type = get_content_type();
         check_sensitive_content(content, content_length, content_type);
         status = check_xss(content, content_length, content_type);
     }
+    else
+    {
+        status = openrasp_output_stream(output_context, content, content_length);
+    }
     return status;
 }
 
-static php_output_handler *openrasp_output_handler_init(const char *handler_name, size_t handler_name_len, size_t chunk_size, int flags)
+/**
+ * chunked handler or explicit flush, the response arrives in pieces:
+ * inspect each one with the state kept in OUTPUT_G and pass it through,
+ * once blocked the rest of the response is dropped.
+ */
+static int openrasp_output_stream(php_output_context *output_context, const char *content, size_t content_length)
 {
-    if (chunk_size)
+    if (!OUTPUT_G(stream_blocked))
+    {
+        auto content_type = get_content_type();
+        if (output_context->op & PHP_OUTPUT_HANDLER_START)
+        {
+            auto type = OpenRASPContentType::classify_content_type(content_type);
+            OUTPUT_G(stream_xss) = (OpenRASPContentType::cTextHtml == type || OpenRASPContentType::cNull == type) &&
+                                   _reflection_scan_start();
+        }
+        check_sensitive_content_chunk(content, content_length, content_type);
+        if (OUTPUT_G(stream_xss) && SUCCESS == check_xss_chunk(content, content_length))
+        {
+            OUTPUT_G(stream_blocked) = true;
+        }
+    }
+    if (!OUTPUT_G(stream_blocked))
     {
-        return nullptr;
+        openrasp_output_pass(output_context);
     }
+    return SUCCESS;
+}
+
+static void openrasp_output_pass(php_output_context *output_context)
+{
+    output_context->out.data = output_context->in.data;
+    output_context->out.used = output_context->in.used;
+    output_context->out.size = output_context->in.size;
+    output_context->out.free = output_context->in.free;
+    output_context->in.data = nullptr;
+    output_context->in.used = 0;
+    output_context->in.size = 0;
+    output_context->in.free = 0;
+}
+
+static php_output_handler *openrasp_output_handler_init(const char *handler_name, size_t handler_name_len, size_t chunk_size, int flags)
+{
     return php_output_handler_create_internal(handler_name, handler_name_len, openrasp_output_handler, chunk_size, flags);
 }
 
-static void openrasp_clean_output_start(const char *name, size_t name_len)
+static void openrasp_clean_output_start(const char *name, size_t name_len, size_t chunk_size)
 {
     php_output_handler *h;
 
-    if ((h = openrasp_output_handler_init(name, name_len, 0, PHP_OUTPUT_HANDLER_STDFLAGS)))
+    if ((h = openrasp_output_handler_init(name, name_len, chunk_size, PHP_OUTPUT_HANDLER_STDFLAGS)))
     {
         php_output_handler_start(h);
     }
@@ -92,16 +140,19 @@ static bool _gpc_parameter_filter(const zval *param)
     return false;
 }
 
-static int _detect_param_occur_in_html_output(const char *param, OpenRASPActionType action)
+static bool _reflection_scan_start()
 {
-    int status = FAILURE;
+    OUTPUT_G(xss_matcher).clear();
+    OUTPUT_G(xss_params).clear();
+    OUTPUT_G(xss_reflected).clear();
+    OUTPUT_G(xss_pending).clear();
+    OUTPUT_G(xss_state) = 0;
     if (Z_TYPE(PG(http_globals)[TRACK_VARS_GET]) != IS_ARRAY &&
         !zend_is_auto_global_str(ZEND_STRL("_GET")))
     {
-        return FAILURE;
+        return false;
     }
     zval *global = &PG(http_globals)[TRACK_VARS_GET];
-    int count = 0;
     zval *val;
     zend_string *key;
     zend_ulong idx;
@@ -109,33 +160,82 @@ static int _detect_param_occur_in_html_output(const char *param, OpenRASPActionT
     {
         if (_gpc_parameter_filter(val))
         {
-            if (++count > OUTPUT_G(max_detection_num))
+            std::string name;
+            if (key != nullptr)
             {
-                continue;
+                name = std::string(ZSTR_VAL(key));
             }
-            if (NULL != strstr(param, Z_STRVAL_P(val)))
+            else
             {
-                std::string name;
-                if (key != nullptr)
-                {
-                    name = std::string(ZSTR_VAL(key));
-                }
-                else
-                {
-                    zend_long actual = idx;
-                    name = std::to_string(actual);
-                }
-                openrasp::data::XssUserInputObject xss_obj(name, val);
-                openrasp::checker::BuiltinDetector builtin_detector(xss_obj);
-                builtin_detector.run();
-                return SUCCESS;
+                zend_long actual = idx;
+                name = std::to_string(actual);
             }
+            OUTPUT_G(xss_matcher).add(Z_STRVAL_P(val), Z_STRLEN_P(val), OUTPUT_G(xss_params).size());
+            OUTPUT_G(xss_params).emplace_back(name, std::string(Z_STRVAL_P(val), Z_STRLEN_P(val)));
         }
     }
     ZEND_HASH_FOREACH_END();
+    if (OUTPUT_G(xss_params).empty())
+    {
+        return false;
+    }
+    OUTPUT_G(xss_matcher).build();
+    OUTPUT_G(xss_reflected).assign(OUTPUT_G(xss_params).size(), false);
+    return true;
+}
+
+static void _reflection_scan(const char *content, size_t content_length)
+{
+    std::vector<bool> &reflected = OUTPUT_G(xss_reflected);
+    std::vector<size_t> &pending = OUTPUT_G(xss_pending);
+    size_t remaining = reflected.size() - std::count(reflected.begin(), reflected.end(), true);
+    if (0 == remaining)
+    {
+        return;
+    }
+    auto visitor = [&reflected, &pending, &remaining](size_t id) {
+        if (!reflected[id])
+        {
+            reflected[id] = true;
+            pending.push_back(id);
+            --remaining;
+        }
+        return remaining > 0;
+    };
+    OUTPUT_G(xss_state) = OUTPUT_G(xss_matcher).scan(content, content_length, visitor, OUTPUT_G(xss_state));
+}
+
+/**
+ * run the builtin detector for parameters found since the last call.
+ */
+static int _reflection_report()
+{
+    int status = FAILURE;
+    for (size_t id : OUTPUT_G(xss_pending))
+    {
+        auto &param = OUTPUT_G(xss_params)[id];
+        zval value;
+        ZVAL_STRINGL(&value, param.second.c_str(), param.second.length());
+        openrasp::data::XssUserInputObject xss_obj(param.first, &value);
+        openrasp::checker::BuiltinDetector builtin_detector(xss_obj);
+        builtin_detector.run();
+        zval_ptr_dtor(&value);
+        status = SUCCESS;
+    }
+    OUTPUT_G(xss_pending).clear();
     return status;
 }
 
+static int _detect_param_occur_in_html_output(const char *content, size_t content_length, OpenRASPActionType action)
+{
+    if (!_reflection_scan_start())
+    {
+        return FAILURE;
+    }
+    _reflection_scan(content, content_length);
+    return _reflection_report();
+}
+
 static const char *get_content_type()
 {
     zend_llist *headers = &SG(sapi_headers).headers;
@@ -161,7 +261,7 @@ static int check_xss(const char *content, size_t content_length, const char *con
     if (OpenRASPContentType::cTextHtml == type || OpenRASPContentType::cNull == type)
     {
         OpenRASPActionType action = openrasp::scm->get_buildin_check_action(XSS_USER_INPUT);
-        status = _detect_param_occur_in_html_output(content, action);
+        status = _detect_param_occur_in_html_output(content, content_length, action);
         if (status == SUCCESS)
         {
             status = (AC_BLOCK == action) ? SUCCESS : FAILURE;
@@ -174,10 +274,30 @@ static int check_xss(const char *content, size_t content_length, const char *con
     return status;
 }
 
-static void check_sensitive_content(const char *content, size_t content_length, const char *content_type)
+static int check_xss_chunk(const char *content, size_t content_length)
+{
+    _reflection_scan(content, content_length);
+    int status = _reflection_report();
+    if (status == SUCCESS)
+    {
+        OpenRASPActionType action = openrasp::scm->get_buildin_check_action(XSS_USER_INPUT);
+        status = (AC_BLOCK == action) ? SUCCESS : FAILURE;
+    }
+    if (status == SUCCESS && !SG(headers_sent))
+    {
+        reset_response();
+    }
+    return status;
+}
+
+/**
+ * only responses with candidates consume the sampler burst, shared by all workers
+ */
+static void run_sensitive_check(const char *content, size_t content_length, const char *content_type)
 {
-    sampler.update(OPENRASP_G(config).response.sampler_interval, OPENRASP_G(config).response.sampler_burst);
-    if (sampler.check())
+    const ResponseBlock &response = OPENRASP_G(config).response;
+    size_t slot = response.sampler_slot(OPENRASP_G(request).url.get_request_uri());
+    if (scm->check_response_sampler(slot, response.sampler_interval, response.sampler_slot_burst(slot)))
     {
         data::ResponseObject data(content, content_length, content_type);
         checker::V8Detector checker(data, OPENRASP_HOOK_G(lru), OPENRASP_V8_G(isolate), OPENRASP_CONFIG(plugin.timeout.millis), false);
@@ -185,6 +305,76 @@ static void check_sensitive_content(const char *content, size_t content_length,
     }
 }
 
+/**
+ * the plugin gets the excerpts around the candidates when its algorithm is known, otherwise the content
+ * after the first checked bytes
+ */
+static void check_sensitive_candidates(const char *content, size_t content_length, const char *content_type,
+                                       const std::vector<SensitiveScanner::Candidate> &candidates, size_t checked)
+{
+    if (!OUTPUT_G(sensitive_prescan))
+    {
+        run_sensitive_check(content + checked, content_length - checked, content_type);
+    }
+    else if (!candidates.empty())
+    {
+        std::string excerpt = SensitiveScanner::excerpt(content, content_length, candidates);
+        run_sensitive_check(excerpt.c_str(), excerpt.length(), content_type);
+    }
+}
+
+static void check_sensitive_content(const char *content, size_t content_length, const char *content_type)
+{
+    if (((1 << RESPONSE) & OPENRASP_HOOK_G(check_type_white_bit_mask)) ||
+        !data::ResponseObject(content, content_length, content_type).is_valid())
+    {
+        return;
+    }
+    std::vector<SensitiveScanner::Candidate> candidates;
+    if (OUTPUT_G(sensitive_prescan))
+    {
+        SensitiveScanner(OUTPUT_G(sensitive_kinds)).scan(content, content_length, candidates);
+    }
+    check_sensitive_candidates(content, content_length, content_type, candidates, 0);
+}
+
+/**
+ * Each chunk is checked along with the end of the previous one, so that data split by the boundary
+ * is still seen as a whole. Candidates within that overlap were checked with the previous chunk,
+ * they are left out and so is the overlap up to the end of the last of them.
+ */
+static void check_sensitive_content_chunk(const char *content, size_t content_length, const char *content_type)
+{
+    if (((1 << RESPONSE) & OPENRASP_HOOK_G(check_type_white_bit_mask)) ||
+        !data::ResponseObject(content, content_length, content_type).is_valid())
+    {
+        return;
+    }
+    std::string &tail = OUTPUT_G(sensitive_tail);
+    size_t overlap = tail.length();
+    tail.append(content, content_length);
+    std::vector<SensitiveScanner::Candidate> found;
+    SensitiveScanner(OUTPUT_G(sensitive_kinds)).scan(tail.c_str(), tail.length(), found);
+    std::vector<SensitiveScanner::Candidate> candidates;
+    size_t checked = 0;
+    for (auto &candidate : found)
+    {
+        if (candidate.offset + candidate.length <= overlap)
+        {
+            checked = candidate.offset + candidate.length;
+        }
+        else
+        {
+            candidates.push_back(candidate);
+        }
+    }
+    check_sensitive_candidates(tail.c_str(), tail.length(), content_type, candidates, checked);
+    if (tail.length() > sensitive_overlap)
+    {
+        tail.erase(0, tail.length() - sensitive_overlap);
+    }
+}
+
 PHP_GINIT_FUNCTION(openrasp_output_detect)
 {
 #ifdef ZTS
@@ -209,9 +399,12 @@ PHP_MINIT_FUNCTION(openrasp_output_detect)
 PHP_RINIT_FUNCTION(openrasp_output_detect)
 {
     OUTPUT_G(output_detect) = false;
+    OUTPUT_G(stream_blocked) = false;
+    OUTPUT_G(stream_xss) = false;
+    OUTPUT_G(sensitive_tail).clear();
     if (!openrasp_check_type_ignored(XSS_USER_INPUT))
     {
-        openrasp_clean_output_start(ZEND_STRL("openrasp_ob_handler"));
+        openrasp_clean_output_start(ZEND_STRL("openrasp_ob_handler"), OPENRASP_CONFIG(response.chunk_size));
     }
     return SUCCESS;
 }
\ No newline at end of file
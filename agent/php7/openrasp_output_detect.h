@@ -18,6 +18,9 @@
 
 #include "openrasp.h"
 #include "openrasp_log.h"
+#include "utils/aho_corasick.h"
+#include "utils/sensitive_scanner.h"
+#include <vector>
 extern "C"
 {
 #ifdef HAVE_CONFIG_H
@@ -33,7 +36,18 @@ ZEND_BEGIN_MODULE_GLOBALS(openrasp_output_detect)
 bool output_detect;
 std::string filter_regex;
 int64_t min_param_length = 15;
-int64_t max_detection_num = 10;
+bool sensitive_prescan = false;
+int sensitive_kinds = openrasp::SensitiveScanner::ALL_KINDS;
+/* state carried across the chunks of a streamed response */
+bool stream_blocked = false;
+bool stream_xss = false;
+openrasp::AhoCorasick xss_matcher;
+// name and value, copied as $_GET may change between chunks
+std::vector<std::pair<std::string, std::string>> xss_params;
+std::vector<bool> xss_reflected;
+std::vector<size_t> xss_pending;
+int32_t xss_state = 0;
+std::string sensitive_tail;
 ZEND_END_MODULE_GLOBALS(openrasp_output_detect)
 
 ZEND_EXTERN_MODULE_GLOBALS(openrasp_output_detect);
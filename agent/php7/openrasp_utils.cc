@@ -428,6 +428,33 @@ bool openrasp_call_user_function(HashTable *function_table, zval *object, const
     return result;
 }
 
+/**
+ * Ends the FastCGI request on php-fpm so the client is not kept waiting for the work done in RSHUTDOWN,
+ * other SAPIs only send the response after every module has shut down.
+ */
+bool finish_fpm_request()
+{
+    if (nullptr == sapi_module.name || strcmp(sapi_module.name, "fpm-fcgi") != 0)
+    {
+        return false;
+    }
+    zend_function *function = static_cast<zend_function *>(zend_hash_str_find_ptr(EG(function_table), ZEND_STRL("fastcgi_finish_request")));
+    if (nullptr == function ||
+        ZEND_INTERNAL_FUNCTION != function->type ||
+        ZEND_FN(display_disabled_function) == function->internal_function.handler)
+    {
+        return false;
+    }
+    bool result = false;
+    zval retval;
+    if (openrasp_call_user_function(EG(function_table), nullptr, "fastcgi_finish_request", &retval, 0, nullptr))
+    {
+        result = (Z_TYPE(retval) == IS_TRUE);
+        zval_ptr_dtor(&retval);
+    }
+    return result;
+}
+
 bool get_long_constant(const std::string &key, long &value)
 {
     bool found = false;
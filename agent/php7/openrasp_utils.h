@@ -63,6 +63,7 @@ bool current_sapi_supported();
 zval *fetch_http_globals(int vars_id);
 bool openrasp_call_user_function(HashTable *function_table, zval *object, const std::string &function_name,
                                  zval *retval_ptr, uint32_t param_count, zval params[]);
+bool finish_fpm_request();
 bool get_long_constant(const std::string &key, long &value);
 bool maybe_ssrf_vulnerability(zval *file);
 bool maybe_ssrf_vulnerability(std::string protcol);
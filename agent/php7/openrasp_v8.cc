@@ -26,13 +26,20 @@ extern "C"
 }
 #include <sstream>
 #include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <unistd.h>
 #include "openrasp_v8.h"
 #include "openrasp_hook.h"
 #include "openrasp_ini.h"
 #include "openrasp_output_detect.h"
 #include "agent/shared_config_manager.h"
+#include "utils/regex.h"
 #ifdef HAVE_OPENRASP_REMOTE_MANAGER
 #include "agent/openrasp_agent_manager.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
 namespace openrasp
@@ -44,6 +51,40 @@ using namespace openrasp;
 
 ZEND_DECLARE_MODULE_GLOBALS(openrasp_v8)
 
+#ifdef HAVE_OPENRASP_REMOTE_MANAGER
+/**
+ * Maps snapshot.dat read only, workers deserialize from the shared page cache instead of private copies.
+ * The agent replaces the file by rename, so a mapping never sees a partially written snapshot.
+ */
+static std::shared_ptr<Snapshot> map_snapshot(const std::string &filename, uint64_t timestamp)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat sb;
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &sb) == 0 && sb.st_size > 0)
+    {
+        addr = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (MAP_FAILED == addr)
+    {
+        return nullptr;
+    }
+    size_t size = sb.st_size;
+    return std::shared_ptr<Snapshot>(new Snapshot(static_cast<const char *>(addr), size, timestamp),
+                                     [addr, size](Snapshot *blob) {
+                                         // not allocated by the blob
+                                         blob->data = nullptr;
+                                         delete blob;
+                                         munmap(addr, size);
+                                     });
+}
+#endif
+
 PHP_GINIT_FUNCTION(openrasp_v8)
 {
 #ifdef ZTS
@@ -59,6 +100,7 @@ PHP_GSHUTDOWN_FUNCTION(openrasp_v8)
         openrasp_v8_globals->isolate->Dispose();
         openrasp_v8_globals->isolate = nullptr;
     }
+    openrasp_v8_globals->snapshot.reset();
 #ifdef ZTS
     openrasp_v8_globals->~_zend_openrasp_v8_globals();
 #endif
@@ -70,6 +112,24 @@ PHP_MINIT_FUNCTION(openrasp_v8)
 
     // initializes v8 only once
     std::call_once(process_globals.init_v8_once, []() {
+        // heap limits apply to every isolate created afterwards
+        std::string flags;
+        if (openrasp_ini.v8_max_old_space_size > 0)
+        {
+            flags += " --max-old-space-size=" + std::to_string(openrasp_ini.v8_max_old_space_size);
+        }
+        if (openrasp_ini.v8_max_semi_space_size > 0)
+        {
+            flags += " --max-semi-space-size=" + std::to_string(openrasp_ini.v8_max_semi_space_size);
+        }
+        if (openrasp_ini.v8_lite_mode)
+        {
+            flags += " --lite-mode";
+        }
+        if (!flags.empty())
+        {
+            v8::V8::SetFlagsFromString(flags.c_str(), flags.length());
+        }
         Initialize(1, plugin_log);
     });
 
@@ -88,30 +148,21 @@ PHP_MINIT_FUNCTION(openrasp_v8)
         Platform::Get()->Startup();
         auto duration = std::chrono::system_clock::now().time_since_epoch();
         auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-        Snapshot *snapshot = new Snapshot(process_globals.plugin_config, process_globals.plugin_src_list, OpenRASPInfo::PHP_OPENRASP_VERSION, millis, nullptr);
+        std::shared_ptr<Snapshot> snapshot(new Snapshot(process_globals.plugin_config, process_globals.plugin_src_list, OpenRASPInfo::PHP_OPENRASP_VERSION, millis, nullptr));
         if (!snapshot->IsOk())
         {
-            delete snapshot;
             openrasp_error(LEVEL_WARNING, PLUGIN_ERROR, _("Fail to initialize builtin js code."));
         }
         else
         {
-            process_globals.snapshot_blob = snapshot;
-            std::map<OpenRASPCheckType, OpenRASPActionType> type_action_map;
-            std::map<std::string, std::string> buildin_action_map = CheckTypeTransfer::instance().get_buildin_action_map();
-            auto duration = std::chrono::system_clock::now().time_since_epoch();
-            auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-            Isolate *isolate = Isolate::New(snapshot, millis);
-            extract_buildin_action(isolate, buildin_action_map);
-            for (auto iter = buildin_action_map.begin(); iter != buildin_action_map.end(); iter++)
-            {
-                type_action_map.insert({CheckTypeTransfer::instance().name_to_type(iter->first), string_to_action(iter->second)});
-            }
-            openrasp::scm->set_buildin_check_action(type_action_map);
-            openrasp::scm->set_mysql_error_codes(extract_int64_array(isolate, "RASP.algorithmConfig.sql_exception.mysql.error_code", SharedConfigBlock::MYSQL_ERROR_CODE_MAX_SIZE));
-            openrasp::scm->set_sqlite_error_codes(extract_int64_array(isolate, "RASP.algorithmConfig.sql_exception.sqlite.error_code", SharedConfigBlock::SQLITE_ERROR_CODE_MAX_SIZE));
-            openrasp::scm->build_pg_error_array(isolate);
-            openrasp::scm->build_env_key_array(isolate);
+            std::atomic_store(&process_globals.snapshot_blob, snapshot);
+            Isolate *isolate = Isolate::New(snapshot.get(), snapshot->timestamp);
+            AlgorithmConfig algorithm_config;
+            extract_algorithm_config(isolate, algorithm_config);
+            algorithm_config.response_handlers = registered_handlers(process_globals.plugin_src_list, "response");
+            openrasp::scm->apply_algorithm_config(algorithm_config);
+            openrasp::scm->write_algorithm_config(algorithm_config, snapshot->timestamp);
+            openrasp::scm->set_unregistered_check_types(unregistered_check_types(process_globals.plugin_src_list));
             isolate->Dispose();
         }
         Platform::Get()->Shutdown();
@@ -128,79 +179,277 @@ PHP_MSHUTDOWN_FUNCTION(openrasp_v8)
     // so skip this step for module graceful reload
     // v8::V8::Dispose();
     // Platform::Get()->Shutdown();
-    delete process_globals.snapshot_blob;
-    process_globals.snapshot_blob = nullptr;
+    std::atomic_store(&process_globals.snapshot_blob, std::shared_ptr<Snapshot>());
 
     return SUCCESS;
 }
 
-PHP_RINIT_FUNCTION(openrasp_v8)
+/**
+ * Replaces the process snapshot when the agent has fetched newer plugins.
+ */
+static void load_snapshot()
 {
 #ifdef HAVE_OPENRASP_REMOTE_MANAGER
     if (openrasp_ini.remote_management_enable && oam != nullptr)
     {
         uint64_t timestamp = oam->get_plugin_update_timestamp();
+        std::shared_ptr<Snapshot> current = std::atomic_load(&process_globals.snapshot_blob);
         if (timestamp > 0 &&
-            (!process_globals.snapshot_blob ||
-             process_globals.snapshot_blob->IsExpired(timestamp)))
+            (!current || current->IsExpired(timestamp)))
         {
             std::unique_lock<std::mutex> lock(process_globals.mtx, std::try_to_lock);
+            current = std::atomic_load(&process_globals.snapshot_blob);
             if (lock &&
-                (!process_globals.snapshot_blob ||
-                 process_globals.snapshot_blob->IsExpired(timestamp)))
+                (!current || current->IsExpired(timestamp)))
             {
                 std::string filename = std::string(openrasp_ini.root_dir) + DEFAULT_SLASH + std::string("snapshot.dat");
-                Snapshot *blob = new Snapshot(filename, timestamp);
-                if (!blob->IsOk())
+                std::shared_ptr<Snapshot> blob = map_snapshot(filename, timestamp);
+                if (!blob)
                 {
-                    delete blob;
+                    blob.reset(new Snapshot(filename, timestamp));
                 }
-                else
+                if (blob->IsOk())
                 {
-                    delete process_globals.snapshot_blob;
-                    process_globals.snapshot_blob = blob;
+                    std::atomic_store(&process_globals.snapshot_blob, blob);
                     OPENRASP_HOOK_G(lru).clear();
                 }
             }
         }
     }
 #endif
-    if (process_globals.snapshot_blob)
+}
+
+/**
+ * Rebuilds the isolate of this thread when it is older than the process snapshot.
+ * Threads that find every renewal slot taken keep serving with their expired isolate and retry at the next request end.
+ */
+static void renew_isolate()
+{
+    std::shared_ptr<Snapshot> snapshot = std::atomic_load(&process_globals.snapshot_blob);
+    if (snapshot)
     {
-        if (!OPENRASP_V8_G(isolate) || OPENRASP_V8_G(isolate)->IsExpired(process_globals.snapshot_blob->timestamp))
+        if (!OPENRASP_V8_G(isolate) || OPENRASP_V8_G(isolate)->IsExpired(snapshot->timestamp))
         {
-            std::unique_lock<std::mutex> lock(process_globals.mtx, std::try_to_lock);
-            if (lock)
+            // a thread without an isolate builds one right away, expired ones are renewed a few threads at a time
+            bool bounded = nullptr != OPENRASP_V8_G(isolate);
+            if (bounded &&
+                process_globals.renewing_isolates.fetch_add(1) >= openrasp_v8_process_globals::max_renewing_isolates)
+            {
+                process_globals.renewing_isolates--;
+                return;
+            }
             {
                 Platform::Get()->Startup();
                 if (OPENRASP_V8_G(isolate))
                 {
                     OPENRASP_V8_G(isolate)->Dispose();
                 }
-                auto isolate = Isolate::New(process_globals.snapshot_blob, process_globals.snapshot_blob->timestamp);
+                auto isolate = Isolate::New(snapshot.get(), snapshot->timestamp);
                 v8::HandleScope handle_scope(isolate);
                 isolate->GetData()->request_context_templ.Reset(isolate, CreateRequestContextTemplate(isolate));
                 OPENRASP_V8_G(isolate) = isolate;
+                // the blob outlives every isolate built from it
+                OPENRASP_V8_G(snapshot) = snapshot;
                 {
-                    static const std::vector<std::string> default_callable_blacklist = {"system", "exec", "passthru", "proc_open", "shell_exec", "popen", "pcntl_exec", "assert"};
-                    static const std::string default_echo_filter_regex = "<![\\\\-\\\\[A-Za-z]|<([A-Za-z]{1,12})[\\\\/ >]";
-                    static const std::string default_filter_regex = "<![\\\\-\\\\[A-Za-z]|<([A-Za-z]{1,12})[\\\\/ >]";
-                    static const int64_t default_min_param_length = 15;
-                    static const int64_t default_max_detection_num = 10;
-
-                    std::vector<std::string> callable_blacklist_vector = extract_string_array(isolate, "RASP.algorithmConfig.webshell_callable.functions", 100, default_callable_blacklist);
-                    OPENRASP_HOOK_G(callable_blacklist) = std::unordered_set<std::string>(callable_blacklist_vector.begin(), callable_blacklist_vector.end());
-                    OPENRASP_HOOK_G(echo_filter_regex) = extract_string(isolate, "RASP.algorithmConfig.xss_echo.filter_regex", default_echo_filter_regex);
-                    OUTPUT_G(filter_regex) = extract_string(isolate, "RASP.algorithmConfig.xss_userinput.filter_regex", default_filter_regex);
-                    OUTPUT_G(min_param_length) = extract_int64(isolate, "RASP.algorithmConfig.xss_userinput.min_length", default_min_param_length);
-                    OUTPUT_G(max_detection_num) = extract_int64(isolate, "RASP.algorithmConfig.xss_userinput.max_detection_num", default_max_detection_num);
+                    // exported once with the snapshot, a worker only reads its isolate when that export is missing
+                    AlgorithmConfig algorithm_config;
+                    if (!openrasp::scm->load_algorithm_config(algorithm_config, snapshot->timestamp))
+                    {
+                        extract_algorithm_config(isolate, algorithm_config);
+                    }
+                    OPENRASP_HOOK_G(callable_blacklist) = std::unordered_set<std::string>(algorithm_config.callable_blacklist.begin(), algorithm_config.callable_blacklist.end());
+                    OPENRASP_HOOK_G(echo_filter_regex) = algorithm_config.echo_filter_regex;
+                    OUTPUT_G(filter_regex) = algorithm_config.userinput_filter_regex;
+                    OUTPUT_G(min_param_length) = algorithm_config.userinput_min_length;
+                    // excerpts are cut for response_dataLeak, any other response handler gets the whole content as before
+                    OUTPUT_G(sensitive_prescan) = !algorithm_config.data_leak_action.empty() && 1 == algorithm_config.response_handlers;
+                    OUTPUT_G(sensitive_kinds) = 0;
+                    if (algorithm_config.data_leak_action != "ignore")
+                    {
+                        if (algorithm_config.data_leak_phone)
+                        {
+                            OUTPUT_G(sensitive_kinds) |= SensitiveScanner::PHONE;
+                        }
+                        if (algorithm_config.data_leak_identity_card)
+                        {
+                            OUTPUT_G(sensitive_kinds) |= SensitiveScanner::IDENTITY_CARD;
+                        }
+                        if (algorithm_config.data_leak_bank_card)
+                        {
+                            OUTPUT_G(sensitive_kinds) |= SensitiveScanner::BANK_CARD;
+                        }
+                    }
+                    openrasp::regex_cache_advance_epoch();
                 }
             }
+            if (bounded)
+            {
+                process_globals.renewing_isolates--;
+            }
         }
     }
+}
+
+namespace openrasp
+{
+/**
+ * Over budget, checks of the request are sampled or skipped depending on their type.
+ */
+bool plugin_budget_allows(OpenRASPCheckType type)
+{
+    if (OPENRASP_V8_G(plugin_budget_micros) <= 0 ||
+        OPENRASP_V8_G(plugin_micros) < OPENRASP_V8_G(plugin_budget_micros))
+    {
+        return true;
+    }
+    int64_t interval = OPENRASP_CONFIG(plugin.budget.sample_interval);
+    if (0 == ((1LL << type) & OPENRASP_CONFIG(plugin.budget.skip_types)) &&
+        interval > 0 &&
+        0 == (OPENRASP_V8_G(budget_sampled) + OPENRASP_V8_G(budget_skipped)) % interval)
+    {
+        ++OPENRASP_V8_G(budget_sampled);
+        return true;
+    }
+    ++OPENRASP_V8_G(budget_skipped);
+    return false;
+}
+
+/**
+ * Whether the RSHUTDOWN of this request loads a snapshot, renews the isolate or trims its heap.
+ */
+bool post_response_work_pending()
+{
+    std::shared_ptr<Snapshot> snapshot = std::atomic_load(&process_globals.snapshot_blob);
+    if (snapshot &&
+        (!OPENRASP_V8_G(isolate) || OPENRASP_V8_G(isolate)->IsExpired(snapshot->timestamp)))
+    {
+        return true;
+    }
+#ifdef HAVE_OPENRASP_REMOTE_MANAGER
+    if (openrasp_ini.remote_management_enable && oam != nullptr)
+    {
+        uint64_t timestamp = oam->get_plugin_update_timestamp();
+        if (timestamp > 0 &&
+            (!snapshot || snapshot->IsExpired(timestamp)))
+        {
+            return true;
+        }
+    }
+#endif
+    // the second quiet request in a row trims
+    return openrasp_ini.v8_idle_trim_millis > 0 &&
+           OPENRASP_V8_G(isolate) &&
+           1 == OPENRASP_V8_G(quiet_requests) &&
+           OPENRASP_V8_G(idle_millis) >= openrasp_ini.v8_idle_trim_millis;
+}
+} // namespace openrasp
+
+/**
+ * plugin.budget.millis, cut in proportion when plugins of all workers take more cpu than plugin.budget.overload_percent
+ */
+static int64_t plugin_budget_micros()
+{
+    int64_t budget = OPENRASP_CONFIG(plugin.budget.millis) * 1000;
+    int64_t overload_percent = OPENRASP_CONFIG(plugin.budget.overload_percent);
+    if (budget > 0 && overload_percent > 0)
+    {
+        static const int64_t cpus = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+        int64_t threshold = cpus * 10000 * overload_percent;
+        int64_t load = openrasp::scm->get_plugin_load();
+        if (load > threshold)
+        {
+            budget = std::max(budget / 10, static_cast<int64_t>(static_cast<double>(budget) * threshold / load));
+        }
+    }
+    return budget;
+}
+
+static int64_t steady_millis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Full GC of an isolate whose worker is lightly loaded, v8 would otherwise keep the heap it grew to.
+ */
+static void trim_isolate(Isolate *isolate)
+{
+    isolate->LowMemoryNotification();
+    if (openrasp::scm->get_debug_level() != 0)
+    {
+        v8::HeapStatistics stats;
+        isolate->GetHeapStatistics(&stats);
+        openrasp_error(LEVEL_DEBUG, PLUGIN_ERROR, _("Trimmed isolate heap, used %zu bytes, total %zu bytes, limit %zu bytes."),
+                       stats.used_heap_size(), stats.total_heap_size(), stats.heap_size_limit());
+    }
+}
+
+PHP_RINIT_FUNCTION(openrasp_v8)
+{
+    // plugin updates are picked up at the end of requests, only a new worker loads plugins here
+    if (!std::atomic_load(&process_globals.snapshot_blob))
+    {
+        load_snapshot();
+    }
+    renew_isolate();
     if (OPENRASP_V8_G(isolate))
     {
         OPENRASP_V8_G(isolate)->GetData()->request_context.Reset();
     }
+    // a fresh worker has not been idle, whatever happened before its fork
+    OPENRASP_V8_G(idle_millis) = OPENRASP_V8_G(last_request_end) > 0 ? steady_millis() - OPENRASP_V8_G(last_request_end) : 0;
+    OPENRASP_V8_G(plugin_micros) = 0;
+    OPENRASP_V8_G(plugin_budget_micros) = plugin_budget_micros();
+    OPENRASP_V8_G(budget_sampled) = 0;
+    OPENRASP_V8_G(budget_skipped) = 0;
+    OPENRASP_V8_G(verdict_memo).clear();
+    return SUCCESS;
+}
+
+PHP_RSHUTDOWN_FUNCTION(openrasp_v8)
+{
+    openrasp::scm->add_plugin_time(OPENRASP_V8_G(plugin_micros));
+    if (OPENRASP_V8_G(budget_sampled) + OPENRASP_V8_G(budget_skipped) > 0)
+    {
+        openrasp::scm->count_budget_degradation(OPENRASP_V8_G(budget_sampled), OPENRASP_V8_G(budget_skipped));
+        if (openrasp::scm->get_debug_level() != 0)
+        {
+            openrasp_error(LEVEL_DEBUG, PLUGIN_ERROR, _("Request (%s) ran out of its plugin budget of %lld us, %lld checks sampled, %lld checks skipped."),
+                           OPENRASP_G(request).get_id().c_str(), (long long)OPENRASP_V8_G(plugin_budget_micros),
+                           (long long)OPENRASP_V8_G(budget_sampled), (long long)OPENRASP_V8_G(budget_skipped));
+        }
+    }
+    if (openrasp::scm->get_debug_level() != 0)
+    {
+        for (auto &item : OPENRASP_V8_G(verdict_memo))
+        {
+            if (item.second.repeats > 0)
+            {
+                openrasp_error(LEVEL_DEBUG, PLUGIN_ERROR, _("Request (%s) skipped %lld repeated checks of %s, its alarm was logged once."),
+                               OPENRASP_G(request).get_id().c_str(), (long long)item.second.repeats, item.first.c_str());
+            }
+        }
+    }
+    OPENRASP_V8_G(verdict_memo).clear();
+    // the response has been ended only on php-fpm with response.finish_early, otherwise the client still waits here
+    load_snapshot();
+    renew_isolate();
+    if (openrasp_ini.v8_idle_trim_millis > 0)
+    {
+        if (OPENRASP_V8_G(idle_millis) >= openrasp_ini.v8_idle_trim_millis)
+        {
+            OPENRASP_V8_G(quiet_requests)++;
+        }
+        else
+        {
+            OPENRASP_V8_G(quiet_requests) = 0;
+        }
+        // the request that woke the worker may open a busy period, trim once the next one came after a gap too
+        if (OPENRASP_V8_G(isolate) && 2 == OPENRASP_V8_G(quiet_requests))
+        {
+            trim_isolate(OPENRASP_V8_G(isolate));
+        }
+    }
+    OPENRASP_V8_G(last_request_end) = steady_millis();
     return SUCCESS;
 }
@@ -19,34 +19,67 @@
 
 #include "openrasp.h"
 #include "hook/checker/check_result.h"
+#include "openrasp_algorithm_config.h"
+#include "openrasp_check_type.h"
 #include "php/header.h"
+#include <atomic>
+#include <memory>
+#include <unordered_map>
 
 namespace openrasp
 {
 class openrasp_v8_process_globals
 {
 public:
-  Snapshot *snapshot_blob = nullptr;
+  // latest snapshot, shared with std::atomic_load/std::atomic_store, isolates hold the one they were built from
+  std::shared_ptr<Snapshot> snapshot_blob;
+  // guards loading snapshot.dat
   std::mutex mtx;
+  // threads rebuilding an expired isolate, at most max_renewing_isolates at once
+  static const int max_renewing_isolates = 2;
+  std::atomic<int> renewing_isolates{0};
   std::string plugin_config = "global.checkPoints=['command','directory','fileUpload','readFile','request','requestEnd','sql','sql_exception','writeFile','xxe','ognl','deserialization','reflection','webdav','ssrf','include','eval','copy','rename','loadLibrary','ssrfRedirect','deleteFile','mongodb','response'];";
   std::vector<PluginFile> plugin_src_list;
   std::once_flag init_v8_once;
 };
 extern openrasp_v8_process_globals process_globals;
-CheckResult Check(Isolate *isolate, v8::Local<v8::String> type, v8::Local<v8::Object> params, int timeout = 100);
+
+// verdict of a check whose alarm was logged, kept for the rest of the request under its lru key
+struct MemoizedVerdict
+{
+  CheckResult result;
+  // identical checks answered from the memo after the alarm was logged
+  int64_t repeats;
+};
+
+CheckResult Check(Isolate *isolate, v8::Local<v8::String> type, v8::Local<v8::Object> params, int timeout = 100, bool *alarmed = nullptr);
+bool plugin_budget_allows(OpenRASPCheckType type);
+bool post_response_work_pending();
 v8::Local<v8::Value> NewV8ValueFromZval(v8::Isolate *isolate, zval *val);
 v8::Local<v8::ObjectTemplate> CreateRequestContextTemplate(Isolate *isolate);
-void extract_buildin_action(Isolate *isolate, std::map<std::string, std::string> &buildin_action_map);
-std::vector<int64_t> extract_int64_array(Isolate *isolate, const std::string &value, int limit, const std::vector<int64_t> &default_value = std::vector<int64_t>());
-std::vector<std::string> extract_string_array(Isolate *isolate, const std::string &value, int limit, const std::vector<std::string> &default_value = std::vector<std::string>());
-int64_t extract_int64(Isolate *isolate, const std::string &value, const int64_t &default_value);
-std::string extract_string(Isolate *isolate, const std::string &value, const std::string &default_value);
+bool extract_algorithm_config(Isolate *isolate, AlgorithmConfig &config);
 void load_plugins();
+uint64_t unregistered_check_types(const std::vector<PluginFile> &plugin_src_list);
+int64_t registered_handlers(const std::vector<PluginFile> &plugin_src_list, const std::string &check_point);
 void plugin_log(const std::string &message);
 } // namespace openrasp
 
 ZEND_BEGIN_MODULE_GLOBALS(openrasp_v8)
 openrasp::Isolate *isolate = nullptr;
+std::shared_ptr<openrasp::Snapshot> snapshot;
+std::unordered_map<std::string, openrasp::MemoizedVerdict> verdict_memo;
+// plugin time of the current request against its budget, both in microseconds, budget 0 for no limit
+int64_t plugin_micros = 0;
+int64_t plugin_budget_micros = 0;
+// checks met over budget, and how many of them still ran
+int64_t budget_sampled = 0;
+int64_t budget_skipped = 0;
+// 0 until the worker has served its first request
+int64_t last_request_end = 0;
+// milliseconds between the end of the previous request and the start of the current one
+int64_t idle_millis = 0;
+// consecutive requests that each followed an idle gap of openrasp.v8_idle_trim_millis
+int64_t quiet_requests = 0;
 ZEND_END_MODULE_GLOBALS(openrasp_v8)
 
 ZEND_EXTERN_MODULE_GLOBALS(openrasp_v8)
@@ -56,6 +89,7 @@ PHP_GSHUTDOWN_FUNCTION(openrasp_v8);
 PHP_MINIT_FUNCTION(openrasp_v8);
 PHP_MSHUTDOWN_FUNCTION(openrasp_v8);
 PHP_RINIT_FUNCTION(openrasp_v8);
+PHP_RSHUTDOWN_FUNCTION(openrasp_v8);
 
 #define OPENRASP_V8_G(v) ZEND_MODULE_GLOBALS_ACCESSOR(openrasp_v8, v)
 
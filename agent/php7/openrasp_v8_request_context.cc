@@ -159,7 +159,7 @@ static void header_getter(v8::Local<v8::Name> name, const v8::PropertyCallbackIn
     v8::Isolate *isolate = info.GetIsolate();
     auto context = isolate->GetCurrentContext();
     v8::Local<v8::Object> obj = v8::Object::New(isolate);
-    std::map<std::string, std::string> headers = OPENRASP_G(request).get_header();
+    const std::map<std::string, std::string> &headers = OPENRASP_G(request).get_header();
     for (auto iter = headers.begin(); iter != headers.end(); iter++)
     {
         obj->Set(context, NewV8String(isolate, iter->first), NewV8String(isolate, iter->second)).IsJust();
@@ -170,42 +170,22 @@ static void body_getter(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo
 {
     info.GetReturnValue().Set(v8::ArrayBuffer::New(info.GetIsolate(), nullptr, 0, v8::ArrayBufferCreationMode::kInternalized));
 
-    php_stream *stream = php_stream_open_wrapper("php://input", "rb", 0, nullptr);
-    if (!stream)
+    size_t maxlen = OPENRASP_CONFIG(body.maxbytes);
+    const std::string &body = OPENRASP_G(request).get_parameter().fetch_body(maxlen);
+    size_t len = MIN(body.length(), maxlen);
+    if (0 == len)
     {
         return;
     }
-
-    size_t len = 0, maxlen = 4 * 1024;
-    char *buffer = (char *)malloc(maxlen);
-    char *ptr = buffer;
-    while ((len < maxlen) && !php_stream_eof(stream))
-    {
-        size_t ret = php_stream_read(stream, ptr, maxlen - len);
-        if (!ret)
-        {
-            break;
-        }
-        len += ret;
-        ptr += ret;
-    }
-    if (len)
-    {
-        *ptr = '\0';
-    }
-    else
-    {
-        free(buffer);
-        buffer = nullptr;
-    }
-
-    stream->is_persistent ? php_stream_pclose(stream) : php_stream_close(stream);
+    // the plugin may keep the buffer beyond this request, so v8 gets its own copy of the cached body
+    char *buffer = (char *)malloc(len);
     if (!buffer)
     {
         return;
     }
+    memcpy(buffer, body.data(), len);
     v8::Isolate *isolate = info.GetIsolate();
-    v8::Local<v8::ArrayBuffer> arraybuffer = v8::ArrayBuffer::New(isolate, buffer, MIN(len, maxlen), v8::ArrayBufferCreationMode::kInternalized);
+    v8::Local<v8::ArrayBuffer> arraybuffer = v8::ArrayBuffer::New(isolate, buffer, len, v8::ArrayBufferCreationMode::kInternalized);
     info.GetReturnValue().Set(arraybuffer);
 }
 static void server_getter(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo<v8::Value> &info)
@@ -237,55 +217,40 @@ static void server_getter(v8::Local<v8::Name> name, const v8::PropertyCallbackIn
 
 static void json_body_getter(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo<v8::Value> &info)
 {
-    if (Z_TYPE(PG(http_globals)[TRACK_VARS_SERVER]) != IS_ARRAY && !zend_is_auto_global_str(ZEND_STRL("_SERVER")))
-    {
-        return;
-    }
-    HashTable *_SERVER = Z_ARRVAL(PG(http_globals)[TRACK_VARS_SERVER]);
     v8::Isolate *isolate = info.GetIsolate();
     v8::Local<v8::Object> obj = v8::Object::New(isolate);
+    info.GetReturnValue().Set(obj);
 
-    std::string complete_body = "{}";
-    zval *origin_zv = nullptr;
-    if (((origin_zv = zend_hash_str_find(_SERVER, ZEND_STRL("HTTP_CONTENT_TYPE"))) != nullptr ||
-         (origin_zv = zend_hash_str_find(_SERVER, ZEND_STRL("CONTENT_TYPE"))) != nullptr) &&
-        Z_TYPE_P(origin_zv) == IS_STRING)
+    openrasp::request::Parameter &parameter = OPENRASP_G(request).get_parameter();
+    size_t len = 0;
+    const char *body = parameter.get_json_body(len);
+    if (0 == len)
     {
-        openrasp_error(LEVEL_DEBUG, RUNTIME_ERROR, _("Content-type of request (%s) is %s."),
-                       OPENRASP_G(request).get_id().c_str(), Z_STRVAL_P(origin_zv));
-        std::string content_type_vlaue = std::string(Z_STRVAL_P(origin_zv));
-        OpenRASPContentType::ContentType k_type = OpenRASPContentType::classify_content_type(content_type_vlaue);
-        zend_string *body = nullptr;
-        if (OpenRASPContentType::ContentType::cApplicationJson == k_type &&
-            (body = fetch_request_body(PHP_STREAM_COPY_ALL)) != nullptr)
-        {
-            if (ZSTR_LEN(body) > 0)
-            {
-                complete_body = std::string(ZSTR_VAL(body));
-            }
-            zend_string_release(body);
-        }
+        return;
     }
-    openrasp_error(LEVEL_DEBUG, RUNTIME_ERROR, _("Complete body of request (%s) is %s."),
-                   OPENRASP_G(request).get_id().c_str(), complete_body.c_str());
+    openrasp_error(LEVEL_DEBUG, RUNTIME_ERROR, _("Complete body of request (%s) is %.*s."),
+                   OPENRASP_G(request).get_id().c_str(), (int)len, body);
     v8::TryCatch trycatch(isolate);
-    auto v8_body = NewV8String(isolate, complete_body);
+    auto v8_body = NewV8String(isolate, body, len);
     auto v8_json_obj = v8::JSON::Parse(isolate->GetCurrentContext(), v8_body);
     if (v8_json_obj.IsEmpty())
     {
         v8::Local<v8::Value> exception = trycatch.Exception();
         v8::String::Utf8Value exception_str(isolate, exception);
         openrasp_error(LEVEL_DEBUG, RUNTIME_ERROR, _("Fail to parse json body, cuz of %s."), *exception_str);
+        parameter.set_json_valid(false);
     }
     else
     {
+        // the alarm log reuses the result instead of parsing the body again
+        parameter.set_json_valid(true);
         auto v8_json_obj_l = v8_json_obj.ToLocalChecked();
         if (v8_json_obj_l->IsObject())
         {
             obj = v8_json_obj_l.As<v8::Object>();
+            info.GetReturnValue().Set(obj);
         }
     }
-    info.GetReturnValue().Set(obj);
 }
 static void requestId_getter(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo<v8::Value> &info)
 {
@@ -22,14 +22,19 @@ extern "C"
 #include "openrasp_utils.h"
 #include "openrasp_log.h"
 #include "openrasp_ini.h"
+#include "agent/shared_config_block.h"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 namespace openrasp
 {
 void alarm_info(Isolate *isolate, v8::Local<v8::String> type, v8::Local<v8::Object> params, v8::Local<v8::Object> result);
 void get_stack(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo<v8::Value> &info);
-CheckResult Check(Isolate *isolate, v8::Local<v8::String> type, v8::Local<v8::Object> params, int timeout)
+/**
+ * @param alarmed set when a log or block alarm was logged, plugin errors and results without action log none
+ */
+CheckResult Check(Isolate *isolate, v8::Local<v8::String> type, v8::Local<v8::Object> params, int timeout, bool *alarmed)
 {
     auto context = isolate->GetCurrentContext();
     auto data = isolate->GetData();
@@ -80,6 +85,10 @@ CheckResult Check(Isolate *isolate, v8::Local<v8::String> type, v8::Local<v8::Ob
             check_result = CheckResult::kBlock;
         }
         alarm_info(isolate, type, params, obj);
+        if (alarmed && (str == "log" || str == "block"))
+        {
+            *alarmed = true;
+        }
     }
     return check_result;
 }
@@ -273,204 +282,287 @@ void load_plugins()
     process_globals.plugin_src_list = plugin_src_list;
 }
 
-void extract_buildin_action(Isolate *isolate, std::map<std::string, std::string> &buildin_action_map)
+static inline bool is_identifier_char(char c)
 {
-    v8::HandleScope handle_scope(isolate);
-    auto context = isolate->GetCurrentContext();
-    // clang-format off
-    auto rst = isolate->ExecScript(R"(
-        Object.keys(RASP.algorithmConfig || {})
-            .filter(key => typeof key === 'string' && typeof RASP.algorithmConfig[key] === 'object' && typeof RASP.algorithmConfig[key].action === 'string')
-            .map(key => [key, RASP.algorithmConfig[key].action])
-    )", "extract_buildin_action");
-    // clang-format on
-    if (rst.IsEmpty())
-    {
-        return;
-    }
-    auto arr = rst.ToLocalChecked().As<v8::Array>();
-    auto len = arr->Length();
-    for (size_t i = 0; i < len; i++)
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$';
+}
+
+/**
+ * Collects the check points of plugin.register('name', ...) calls.
+ * @return false if register is used any other way, e.g. with a computed name, then any check point may have handlers
+ */
+static bool scan_registered_check_points(const std::string &source, std::vector<std::string> &names)
+{
+    static const std::string keyword = "register";
+    size_t len = source.length();
+    for (size_t pos = source.find(keyword); pos != std::string::npos; pos = source.find(keyword, pos + keyword.length()))
     {
-        v8::HandleScope handle_scope(isolate);
-        v8::Local<v8::Value> item;
-        if (!arr->Get(context, i).ToLocal(&item) || !item->IsArray())
+        size_t end = pos + keyword.length();
+        if ((pos > 0 && is_identifier_char(source[pos - 1])) ||
+            (end < len && is_identifier_char(source[end])))
         {
             continue;
         }
-        v8::String::Utf8Value key(isolate, item.As<v8::Array>()->Get(context, 0).ToLocalChecked());
-        v8::String::Utf8Value value(isolate, item.As<v8::Array>()->Get(context, 1).ToLocalChecked());
-        auto iter = buildin_action_map.find({*key, key.length()});
-        if (iter != buildin_action_map.end())
+        size_t i = pos;
+        while (i > 0 && isspace((unsigned char)source[i - 1]))
+        {
+            --i;
+        }
+        if (0 == i || source[i - 1] != '.')
+        {
+            return false;
+        }
+        i = end;
+        while (i < len && isspace((unsigned char)source[i]))
+        {
+            ++i;
+        }
+        if (i >= len || source[i] != '(')
+        {
+            return false;
+        }
+        ++i;
+        while (i < len && isspace((unsigned char)source[i]))
+        {
+            ++i;
+        }
+        if (i >= len || (source[i] != '\'' && source[i] != '"'))
+        {
+            return false;
+        }
+        size_t close = source.find(source[i], i + 1);
+        if (close == std::string::npos)
+        {
+            return false;
+        }
+        std::string name = source.substr(i + 1, close - i - 1);
+        if (name.find('\\') != std::string::npos)
         {
-            iter->second = std::string(*value, value.length());
+            return false;
         }
+        names.push_back(name);
     }
+    return true;
 }
 
-std::vector<int64_t> extract_int64_array(Isolate *isolate, const std::string &value, int limit, const std::vector<int64_t> &default_value)
+uint64_t unregistered_check_types(const std::vector<PluginFile> &plugin_src_list)
 {
-    if (nullptr != isolate)
+    std::vector<std::string> names;
+    for (auto &plugin_src : plugin_src_list)
     {
-        std::string script = R"(
-        (function () 
+        if (!scan_registered_check_points(plugin_src.source, names))
         {
-            try {
-                    return )" +
-                             value + R"(.filter(value => typeof value === 'number');
-                } catch (_) {}
-        })()
-        )";
-        v8::HandleScope handle_scope(isolate);
-        auto context = isolate->GetCurrentContext();
-        auto rst = isolate->ExecScript(script, "extract_int64_array_" + value);
-        if (!rst.IsEmpty())
+            return 0;
+        }
+    }
+    // hook types whose hooks do nothing but call the plugin, with the check point they call
+    // dbConnection runs native policy checks, builtin types run native detectors, neither is listed
+    static const std::map<OpenRASPCheckType, std::string> plugin_only_types = {
+        {COMMAND, "command"},
+        {DIRECTORY, "directory"},
+        {READ_FILE, "readFile"},
+        {WRITE_FILE, "writeFile"},
+        {DELETE_FILE, "deleteFile"},
+        {COPY, "copy"},
+        {RENAME, "rename"},
+        {FILE_UPLOAD, "fileUpload"},
+        {INCLUDE, "include"},
+        {EVAL, "eval"},
+        {SQL, "sql"},
+        {SQL_PREPARED, "sql"},
+        {SQL_ERROR, "sql_exception"},
+        {SSRF, "ssrf"},
+        {SSRF_REDIRECT, "ssrfRedirect"},
+        {REQUEST, "request"},
+        {REQUEST_END, "requestEnd"},
+        {MONGO, "mongodb"},
+        {RESPONSE, "response"}};
+    uint64_t mask = 0;
+    for (auto &item : plugin_only_types)
+    {
+        if (std::find(names.begin(), names.end(), item.second) == names.end())
         {
-            std::vector<int64_t> result;
-            auto v8_arr = rst.ToLocalChecked();
-            if (!v8_arr.IsEmpty() && v8_arr->IsArray())
-            {
-                auto arr = v8_arr.As<v8::Array>();
-                auto len = arr->Length();
-                if (len > limit)
-                {
-                    openrasp_error(LEVEL_WARNING, PLUGIN_ERROR,
-                                   _("Size of %s must <= %d."), value.c_str(), limit);
-                }
-                for (size_t i = 0; i < len; i++)
-                {
-                    v8::HandleScope handle_scope(isolate);
-                    auto item = arr->Get(context, i).ToLocalChecked();
-                    if (!item.IsEmpty() && item->IsInt32())
-                    {
-                        v8::Local<v8::Integer> err_code_local = item.As<v8::Integer>();
-                        int64_t err_code = err_code_local->Value();
-                        result.push_back(err_code);
-                    }
-                }
-                return result;
-            }
+            mask |= (1ULL << item.first);
         }
     }
-    return default_value;
+    return mask;
 }
 
-std::vector<std::string> extract_string_array(Isolate *isolate, const std::string &value, int limit, const std::vector<std::string> &default_value)
+/**
+ * @return -1 if a plugin uses register in a way the names can not be told
+ */
+int64_t registered_handlers(const std::vector<PluginFile> &plugin_src_list, const std::string &check_point)
 {
-    if (nullptr != isolate)
+    std::vector<std::string> names;
+    for (auto &plugin_src : plugin_src_list)
     {
-        std::string script;
-        script.append(R"( 
-        (function () 
-        {
-            try {
-                return )")
-            .append(value)
-            .append(R"(.filter(value => typeof value === 'string')
-            } catch (_) {}
-        })()
-        )");
-        v8::HandleScope handle_scope(isolate);
-        auto context = isolate->GetCurrentContext();
-        auto rst = isolate->ExecScript(script, "extract_string_array_" + value);
-        if (!rst.IsEmpty())
+        if (!scan_registered_check_points(plugin_src.source, names))
         {
-            std::vector<std::string> result;
-            auto v8_arr = rst.ToLocalChecked();
-            if (!v8_arr.IsEmpty() && v8_arr->IsArray())
-            {
-                auto arr = v8_arr.As<v8::Array>();
-                auto len = arr->Length();
-                if (len > limit)
-                {
-                    openrasp_error(LEVEL_WARNING, PLUGIN_ERROR,
-                                   _("Size of %s must <= %d."), value.c_str(), limit);
-                }
-                for (size_t i = 0; i < len; i++)
-                {
-                    v8::HandleScope handle_scope(isolate);
-                    v8::Local<v8::Value> item;
-                    if (!arr->Get(context, i).ToLocal(&item) || !item->IsString())
-                    {
-                        continue;
-                    }
-                    v8::String::Utf8Value value(isolate, item);
-                    result.push_back(std::string(*value, value.length()));
-                }
-                return result;
-            }
+            return -1;
         }
     }
-    return default_value;
+    return std::count(names.begin(), names.end(), check_point);
 }
 
-int64_t extract_int64(Isolate *isolate, const std::string &value, const int64_t &default_value)
+/**
+ * Walks plain properties, accessors of the plugin are not expected on these paths.
+ */
+static bool get_path(v8::Isolate *isolate, v8::Local<v8::Value> root, const std::vector<std::string> &path, v8::Local<v8::Value> &result)
 {
-    if (nullptr != isolate)
+    auto context = isolate->GetCurrentContext();
+    v8::Local<v8::Value> value = root;
+    for (auto &key : path)
     {
-        std::string script = R"(
-        (function () 
+        if (value.IsEmpty() || !value->IsObject() ||
+            !value.As<v8::Object>()->Get(context, NewV8String(isolate, key)).ToLocal(&value))
         {
-            try {
-                    if (Number.isInteger()" +
-                             value + R"())
-                    {
-                        return )" +
-                             value + R"(
-                    }
-                } catch (_) {}
-        })()
-        )";
-        v8::HandleScope handle_scope(isolate);
-        auto context = isolate->GetCurrentContext();
-        auto rst = isolate->ExecScript(script, "extract_int64_" + value);
-        if (!rst.IsEmpty())
+            return false;
+        }
+    }
+    result = value;
+    return !result.IsEmpty() && !result->IsUndefined();
+}
+
+static std::string path_name(const std::vector<std::string> &path)
+{
+    std::string name = "RASP.algorithmConfig";
+    for (auto &key : path)
+    {
+        name.append(".").append(key);
+    }
+    return name;
+}
+
+static void get_int64_array(v8::Isolate *isolate, v8::Local<v8::Value> root, const std::vector<std::string> &path, size_t limit, std::vector<int64_t> &result)
+{
+    v8::HandleScope handle_scope(isolate);
+    auto context = isolate->GetCurrentContext();
+    v8::Local<v8::Value> value;
+    if (!get_path(isolate, root, path, value) || !value->IsArray())
+    {
+        return;
+    }
+    auto arr = value.As<v8::Array>();
+    result.clear();
+    for (uint32_t i = 0; i < arr->Length(); i++)
+    {
+        v8::Local<v8::Value> item;
+        if (arr->Get(context, i).ToLocal(&item) && item->IsInt32())
         {
-            v8::HandleScope handle_scope(isolate);
-            auto v8_value = rst.ToLocalChecked();
-            if (!v8_value.IsEmpty() && v8_value->IsInt32())
-            {
-                v8::Local<v8::Integer> v8_result = v8_value.As<v8::Integer>();
-                return v8_result->Value();
-            }
+            result.push_back(item.As<v8::Int32>()->Value());
         }
     }
-    return default_value;
+    if (result.size() > limit)
+    {
+        openrasp_error(LEVEL_WARNING, PLUGIN_ERROR, _("Size of %s must <= %zu."), path_name(path).c_str(), limit);
+    }
 }
 
-std::string extract_string(Isolate *isolate, const std::string &value, const std::string &default_value)
+static void get_string_array(v8::Isolate *isolate, v8::Local<v8::Value> root, const std::vector<std::string> &path, size_t limit, std::vector<std::string> &result)
 {
-    if (nullptr != isolate)
+    v8::HandleScope handle_scope(isolate);
+    auto context = isolate->GetCurrentContext();
+    v8::Local<v8::Value> value;
+    if (!get_path(isolate, root, path, value) || !value->IsArray())
+    {
+        return;
+    }
+    auto arr = value.As<v8::Array>();
+    result.clear();
+    for (uint32_t i = 0; i < arr->Length(); i++)
     {
-        std::string script = R"(
-        (function () 
+        v8::Local<v8::Value> item;
+        if (arr->Get(context, i).ToLocal(&item) && item->IsString())
         {
-            try {
-                    if (typeof )" +
-                             value + R"( === 'string')
-                    {
-                        return )" +
-                             value + R"(
-                    }
-                } catch (_) {}
+            v8::String::Utf8Value str(isolate, item);
+            result.emplace_back(*str, str.length());
+        }
+    }
+    if (result.size() > limit)
+    {
+        openrasp_error(LEVEL_WARNING, PLUGIN_ERROR, _("Size of %s must <= %zu."), path_name(path).c_str(), limit);
+    }
+}
+
+static void get_int64(v8::Isolate *isolate, v8::Local<v8::Value> root, const std::vector<std::string> &path, int64_t &result)
+{
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Value> value;
+    if (get_path(isolate, root, path, value) && value->IsInt32())
+    {
+        result = value.As<v8::Int32>()->Value();
+    }
+}
+
+static void get_string(v8::Isolate *isolate, v8::Local<v8::Value> root, const std::vector<std::string> &path, std::string &result)
+{
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Value> value;
+    if (get_path(isolate, root, path, value) && value->IsString())
+    {
+        v8::String::Utf8Value str(isolate, value);
+        result = std::string(*str, str.length());
+    }
+}
+
+static void get_bool(v8::Isolate *isolate, v8::Local<v8::Value> root, const std::vector<std::string> &path, bool &result)
+{
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Value> value;
+    if (get_path(isolate, root, path, value) && value->IsBoolean())
+    {
+        result = value->IsTrue();
+    }
+}
+
+bool extract_algorithm_config(Isolate *isolate, AlgorithmConfig &config)
+{
+    if (nullptr == isolate)
+    {
+        return false;
+    }
+    v8::HandleScope handle_scope(isolate);
+    auto context = isolate->GetCurrentContext();
+    v8::TryCatch try_catch(isolate);
+    // the only script, the rest is read natively
+    // clang-format off
+    auto rst = isolate->ExecScript(R"(
+        (function () {
+            try { return RASP.algorithmConfig } catch (_) {}
         })()
-        )";
-        v8::HandleScope handle_scope(isolate);
-        auto context = isolate->GetCurrentContext();
-        auto rst = isolate->ExecScript(script, "extract_string_" + value);
-        if (!rst.IsEmpty())
+    )", "extract_algorithm_config");
+    // clang-format on
+    v8::Local<v8::Value> algorithm_config;
+    if (!rst.ToLocal(&algorithm_config))
+    {
+        return false;
+    }
+    if (algorithm_config->IsObject())
+    {
+        std::map<std::string, std::string> buildin_action_map = CheckTypeTransfer::instance().get_buildin_action_map();
+        for (auto &item : buildin_action_map)
         {
-            v8::HandleScope handle_scope(isolate);
-            auto v8_value = rst.ToLocalChecked();
-            if (!v8_value.IsEmpty() && v8_value->IsString())
+            std::string action;
+            get_string(isolate, algorithm_config, {item.first, "action"}, action);
+            if (!action.empty())
             {
-                v8::Local<v8::String> v8_result = v8_value.As<v8::String>();
-                v8::String::Utf8Value value(isolate, v8_result);
-                return std::string(*value, value.length());
+                config.buildin_actions[item.first] = action;
             }
         }
+        get_int64_array(isolate, algorithm_config, {"sql_exception", "mysql", "error_code"}, SharedConfigBlock::MYSQL_ERROR_CODE_MAX_SIZE, config.mysql_error_codes);
+        get_int64_array(isolate, algorithm_config, {"sql_exception", "sqlite", "error_code"}, SharedConfigBlock::SQLITE_ERROR_CODE_MAX_SIZE, config.sqlite_error_codes);
+        get_string_array(isolate, algorithm_config, {"sql_exception", "pgsql", "error_code"}, SharedConfigBlock::PGSQL_ERROR_CODE_MAX_SIZE, config.pgsql_error_codes);
+        get_string_array(isolate, algorithm_config, {"webshell_ld_preload", "env"}, SharedConfigBlock::WEBSHELL_ENV_KEY_MAX_SIZE, config.ld_preload_env);
+        get_string_array(isolate, algorithm_config, {"webshell_callable", "functions"}, 100, config.callable_blacklist);
+        get_string(isolate, algorithm_config, {"xss_echo", "filter_regex"}, config.echo_filter_regex);
+        get_string(isolate, algorithm_config, {"xss_userinput", "filter_regex"}, config.userinput_filter_regex);
+        get_int64(isolate, algorithm_config, {"xss_userinput", "min_length"}, config.userinput_min_length);
+        get_string(isolate, algorithm_config, {"response_dataLeak", "action"}, config.data_leak_action);
+        get_bool(isolate, algorithm_config, {"response_dataLeak", "kind", "phone"}, config.data_leak_phone);
+        get_bool(isolate, algorithm_config, {"response_dataLeak", "kind", "identity_card"}, config.data_leak_identity_card);
+        get_bool(isolate, algorithm_config, {"response_dataLeak", "kind", "bank_card"}, config.data_leak_bank_card);
     }
-    return default_value;
+    return true;
 }
 
 } // namespace openrasp
\ No newline at end of file
@@ -0,0 +1,30 @@
+--TEST--
+plugin budget skip
+--SKIPIF--
+<?php
+$plugin = <<<EOF
+plugin.register('directory', params => {
+    const start = Date.now()
+    while (Date.now() - start < 20);
+})
+plugin.register('command', params => {
+    assert(params.command == 'echo test')
+    return block
+})
+EOF;
+$conf = <<<CONF
+plugin.budget.millis: 10
+plugin.budget.sample_interval: 0
+plugin.budget.overload_percent: 0
+CONF;
+include(__DIR__.'/skipif.inc');
+?>
+--INI--
+openrasp.root_dir=/tmp/openrasp
+--FILE--
+<?php
+scandir(__DIR__);
+echo exec('echo test');
+?>
+--EXPECT--
+test
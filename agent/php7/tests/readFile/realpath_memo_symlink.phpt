@@ -0,0 +1,29 @@
+--TEST--
+re-pointed symlink is resolved again within a request
+--SKIPIF--
+<?php
+$plugin = <<<EOF
+plugin.register('readFile', params => {
+    if (params.realpath.endsWith('/tmp/openrasp/realpath_memo_b')) {
+        return block
+    }
+})
+EOF;
+include(__DIR__.'/../skipif.inc');
+?>
+--INI--
+openrasp.root_dir=/tmp/openrasp
+--FILE--
+<?php
+ini_set('display_errors', 'off');
+file_put_contents('/tmp/openrasp/realpath_memo_a', 'a');
+file_put_contents('/tmp/openrasp/realpath_memo_b', 'b');
+@unlink('/tmp/openrasp/realpath_memo_link');
+symlink('/tmp/openrasp/realpath_memo_a', '/tmp/openrasp/realpath_memo_link');
+echo file_get_contents('/tmp/openrasp/realpath_memo_link');
+unlink('/tmp/openrasp/realpath_memo_link');
+symlink('/tmp/openrasp/realpath_memo_b', '/tmp/openrasp/realpath_memo_link');
+echo file_get_contents('/tmp/openrasp/realpath_memo_link');
+?>
+--EXPECTREGEX--
+.*<\/script><script>location.href="http[s]?:\/\/.*?request_id=[0-9a-f]{32}"<\/script>
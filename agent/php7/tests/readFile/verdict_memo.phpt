@@ -0,0 +1,27 @@
+--TEST--
+repeated read of the same file reuses the log verdict
+--SKIPIF--
+<?php
+$plugin = <<<EOF
+let count = 0
+plugin.register('readFile', params => {
+    assert(params.realpath.endsWith('/tmp/openrasp/verdict_memo'))
+    count++
+    if (count == 1) {
+        return {action: 'log'}
+    }
+    return block
+})
+EOF;
+include(__DIR__.'/../skipif.inc');
+?>
+--INI--
+openrasp.root_dir=/tmp/openrasp
+--FILE--
+<?php
+file_put_contents('/tmp/openrasp/verdict_memo', 'ok');
+file_get_contents('/tmp/openrasp/verdict_memo');
+echo file_get_contents('/tmp/openrasp/verdict_memo');
+?>
+--EXPECT--
+ok
@@ -0,0 +1,27 @@
+--TEST--
+a plugin error is not memoized as a verdict
+--SKIPIF--
+<?php
+$plugin = <<<EOF
+let count = 0
+plugin.register('readFile', params => {
+    assert(params.realpath.endsWith('/tmp/openrasp/verdict_memo_exception'))
+    count++
+    if (count == 1) {
+        throw new Error('verdict memo exception')
+    }
+    return block
+})
+EOF;
+include(__DIR__.'/../skipif.inc');
+?>
+--INI--
+openrasp.root_dir=/tmp/openrasp
+--FILE--
+<?php
+file_put_contents('/tmp/openrasp/verdict_memo_exception', 'ok');
+file_get_contents('/tmp/openrasp/verdict_memo_exception');
+echo file_get_contents('/tmp/openrasp/verdict_memo_exception');
+?>
+--EXPECTREGEX--
+<\/script><script>location.href="http[s]?:\/\/.*?request_id=[0-9a-f]{32}"<\/script>
\ No newline at end of file
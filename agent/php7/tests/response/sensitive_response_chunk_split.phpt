@@ -0,0 +1,47 @@
+--TEST--
+policy sensitive response (number split across response chunks)
+--SKIPIF--
+<?php
+$plugin = <<<EOF
+RASP.algorithmConfig = {
+    response_dataLeak: {
+        action: 'log',
+        kind: {
+            phone:         true,
+            identity_card: false,
+            bank_card:     false
+        }
+    }
+}
+plugin.register('response', params => {
+  // the number begins in the end of the previous chunk carried over
+  assert(params.content.indexOf('tel: 13800138000') != -1)
+  return {
+    action: 'log',
+    message: 'sensitive chunk split',
+    params: {
+      a: 1
+    }
+  }
+})
+EOF;
+$conf = <<<CONF
+response.chunk_size: 64
+
+CONF;
+include(__DIR__.'/../skipif.inc');
+?>
+--INI--
+openrasp.root_dir=/tmp/openrasp
+expose_php=false
+display_errors=false
+--FILE--
+<?php
+include(__DIR__.'/../timezone.inc');
+echo str_repeat('<p>hello</p>', 5) . 'tel: 138001';
+echo '38000' . str_repeat('<p>hello</p>', 5);
+ob_flush();
+passthru('tail -n 1 /tmp/openrasp/logs/alarm/alarm.log.'.date("Y-m-d"));
+?>
+--EXPECTREGEX--
+.*tel: 13800138000.*"plugin_message":"sensitive chunk split".*
\ No newline at end of file
@@ -0,0 +1,42 @@
+--TEST--
+policy sensitive response (native pre-scan)
+--SKIPIF--
+<?php
+$plugin = <<<EOF
+RASP.algorithmConfig = {
+    response_dataLeak: {
+        action: 'log',
+        kind: {
+            phone:         true,
+            identity_card: false,
+            bank_card:     false
+        }
+    }
+}
+plugin.register('response', params => {
+  assert(params.content.indexOf('13800138000') != -1)
+  assert(params.content.length < 200)
+  return {
+    action: 'log',
+    message: 'sensitive prescan',
+    params: {
+      a: 1
+    }
+  }
+})
+EOF;
+include(__DIR__.'/../skipif.inc');
+?>
+--INI--
+openrasp.root_dir=/tmp/openrasp
+expose_php=false
+display_errors=false
+--FILE--
+<?php
+include(__DIR__.'/../timezone.inc');
+echo str_repeat('<p>hello world</p>', 100) . 'tel: 13800138000' . str_repeat('<p>hello world</p>', 100);
+ob_flush();
+passthru('tail -n 1 /tmp/openrasp/logs/alarm/alarm.log.'.date("Y-m-d"));
+?>
+--EXPECTREGEX--
+.*tel: 13800138000.*"plugin_message":"sensitive prescan".*
@@ -0,0 +1,26 @@
+--TEST--
+hook PDO::prepare sqlite with only sql registered
+--SKIPIF--
+<?php
+$plugin = <<<EOF
+plugin.register('sql', params => {
+    assert(params.query == 'SELECT a FROM b WHERE c < :c')
+    assert(params.server == 'sqlite')
+    return block
+})
+EOF;
+$conf = <<<CONF
+security.enforce_policy: false
+CONF;
+include(__DIR__.'/../skipif.inc');
+if (!extension_loaded("pdo_sqlite")) die("Skipped: pdo_sqlite extension required.");
+?>
+--INI--
+openrasp.root_dir=/tmp/openrasp
+--FILE--
+<?php
+$con = new PDO('sqlite::memory:');
+$con->prepare('SELECT a FROM b WHERE c < :c');
+?>
+--EXPECTREGEX--
+<\/script><script>location.href="http[s]?:\/\/.*?request_id=[0-9a-f]{32}"<\/script>
@@ -0,0 +1,35 @@
+--TEST--
+hook output detect (reflection xss in the first response chunk)
+--SKIPIF--
+<?php
+$plugin = <<<EOF
+RASP.algorithmConfig = {
+     xss_userinput: {
+        action: 'block',
+        filter_regex: "<![\\\\-\\\\[A-Za-z]|<([A-Za-z]{1,12})[\\\\/ >]",
+        min_length: 15,
+        max_detection_num: 10
+    }
+}
+EOF;
+$conf = <<<CONF
+block.redirect_url: "/block?request_id="
+response.chunk_size: 64
+
+CONF;
+include(__DIR__.'/../skipif.inc');
+?>
+--INI--
+openrasp.root_dir=/tmp/openrasp
+--CGI--
+--GET--
+a=<script>alert("xss")</script>
+--FILE--
+<?php
+// streamed, but no chunk has been sent when the value shows up
+echo '<pre>' . $_GET['a'] . '</pre>' . str_repeat('a', 64);
+echo 'after the block';
+?>
+--EXPECTHEADERS--
+Location: /block?request_id=
+--EXPECT--
\ No newline at end of file
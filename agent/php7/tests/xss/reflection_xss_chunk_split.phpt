@@ -0,0 +1,35 @@
+--TEST--
+hook output detect (reflection xss split across response chunks)
+--SKIPIF--
+<?php
+$plugin = <<<EOF
+RASP.algorithmConfig = {
+     xss_userinput: {
+        action: 'block',
+        filter_regex: "<![\\\\-\\\\[A-Za-z]|<([A-Za-z]{1,12})[\\\\/ >]",
+        min_length: 15,
+        max_detection_num: 10
+    }
+}
+EOF;
+$conf = <<<CONF
+block.redirect_url: "/block?request_id="
+response.chunk_size: 64
+
+CONF;
+include(__DIR__.'/../skipif.inc');
+?>
+--INI--
+openrasp.root_dir=/tmp/openrasp
+--CGI--
+--GET--
+a=<script>alert("xss")</script>
+--FILE--
+<?php
+// the first chunk ends inside the value, only the matcher state carried to the next chunk finds it
+echo str_repeat('a', 60) . '<pre>' . substr($_GET['a'], 0, 10);
+echo substr($_GET['a'], 10) . '</pre>' . str_repeat('b', 64);
+echo 'after the block';
+?>
+--EXPECTREGEX--
+^a{60}<pre><script>al$
\ No newline at end of file
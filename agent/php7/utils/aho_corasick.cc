@@ -0,0 +1,129 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "aho_corasick.h"
+#include <queue>
+
+namespace openrasp
+{
+
+void AhoCorasick::add(const char *pattern, size_t len, size_t id)
+{
+    if (pattern != nullptr && len > 0)
+    {
+        patterns.emplace_back(std::string(pattern, len), id);
+    }
+}
+
+void AhoCorasick::clear()
+{
+    patterns.clear();
+    table.clear();
+    outputs.clear();
+    output_links.clear();
+}
+
+void AhoCorasick::build()
+{
+    memset(byte_class, 0, sizeof(byte_class));
+    memset(start_byte, 0, sizeof(start_byte));
+    start_byte_count = 0;
+    class_count = 1;
+    table.clear();
+    outputs.clear();
+    output_links.clear();
+    if (patterns.empty())
+    {
+        return;
+    }
+
+    for (auto &pattern : patterns)
+    {
+        for (unsigned char c : pattern.first)
+        {
+            if (0 == byte_class[c])
+            {
+                byte_class[c] = class_count++;
+            }
+        }
+        unsigned char first = pattern.first[0];
+        if (!start_byte[first])
+        {
+            start_byte[first] = true;
+            only_start_byte = first;
+            ++start_byte_count;
+        }
+    }
+
+    // trie, missing edges are -1
+    outputs.emplace_back();
+    table.assign(class_count, -1);
+    for (auto &pattern : patterns)
+    {
+        int32_t state = 0;
+        for (unsigned char c : pattern.first)
+        {
+            int32_t &next = table[state * class_count + byte_class[c]];
+            if (next < 0)
+            {
+                next = outputs.size();
+                outputs.emplace_back();
+                table.resize(table.size() + class_count, -1);
+            }
+            state = table[state * class_count + byte_class[c]];
+        }
+        outputs[state].push_back(pattern.second);
+    }
+
+    // breadth first: resolve failure links into the table, chain states with outputs
+    std::vector<int32_t> fail(outputs.size(), 0);
+    output_links.assign(outputs.size(), 0);
+    std::queue<int32_t> queue;
+    for (size_t c = 0; c < class_count; ++c)
+    {
+        int32_t &next = table[c];
+        if (next < 0)
+        {
+            next = 0;
+        }
+        else
+        {
+            queue.push(next);
+        }
+    }
+    while (!queue.empty())
+    {
+        int32_t state = queue.front();
+        queue.pop();
+        int32_t link = fail[state];
+        output_links[state] = outputs[link].empty() ? output_links[link] : link;
+        for (size_t c = 0; c < class_count; ++c)
+        {
+            int32_t &next = table[state * class_count + c];
+            if (next < 0)
+            {
+                next = table[link * class_count + c];
+            }
+            else
+            {
+                fail[next] = table[link * class_count + c];
+                queue.push(next);
+            }
+        }
+    }
+}
+
+} // namespace openrasp
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _OPENRASP_UTILS_AHO_CORASICK_H_
+#define _OPENRASP_UTILS_AHO_CORASICK_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace openrasp
+{
+
+/**
+ * Multi-pattern substring matcher, all patterns are found in a single pass over the text.
+ *
+ * Bytes are mapped to equivalence classes (bytes absent from every pattern share class 0),
+ * and the goto/failure functions are flattened into a dense state x class table,
+ * so every input byte costs one table lookup. While in the root state the scan jumps to
+ * the next byte that can start a pattern with memchr when there is a single such byte.
+ */
+class AhoCorasick
+{
+public:
+  /**
+   * empty patterns are ignored, id is reported back by scan().
+   */
+  void add(const char *pattern, size_t len, size_t id);
+  void build();
+  void clear();
+  bool empty() const { return patterns.empty(); }
+  size_t state_count() const { return outputs.size(); }
+
+  /**
+   * visitor is called as visitor(id) for each occurrence of each pattern,
+   * scanning stops as soon as visitor returns false.
+   * @param state state returned by the previous call, to scan a text split into chunks
+   * @return state to resume with, patterns spanning chunks are still found
+   */
+  template <typename Visitor>
+  int32_t scan(const char *text, size_t len, Visitor visitor, int32_t state = 0) const
+  {
+    if (table.empty())
+    {
+      return 0;
+    }
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(text);
+    const unsigned char *end = p + len;
+    while (p < end)
+    {
+      if (0 == state)
+      {
+        p = skip_to_start(p, end);
+        if (p == end)
+        {
+          return state;
+        }
+      }
+      state = table[state * class_count + byte_class[*p++]];
+      for (int32_t out = state; out > 0; out = output_links[out])
+      {
+        for (size_t id : outputs[out])
+        {
+          if (!visitor(id))
+          {
+            return state;
+          }
+        }
+      }
+    }
+    return state;
+  }
+
+private:
+  std::vector<std::pair<std::string, size_t>> patterns;
+  // up to 257 classes when patterns use every byte value
+  uint16_t byte_class[256] = {0};
+  bool start_byte[256] = {false};
+  int start_byte_count = 0;
+  unsigned char only_start_byte = 0;
+  size_t class_count = 0;
+  std::vector<int32_t> table;
+  std::vector<std::vector<size_t>> outputs;
+  std::vector<int32_t> output_links;
+
+  const unsigned char *skip_to_start(const unsigned char *p, const unsigned char *end) const
+  {
+    if (1 == start_byte_count)
+    {
+      const void *found = memchr(p, only_start_byte, end - p);
+      return found ? static_cast<const unsigned char *>(found) : end;
+    }
+    while (p < end && !start_byte[*p])
+    {
+      ++p;
+    }
+    return p;
+  }
+};
+
+} // namespace openrasp
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "blob.h"
+#include <cstring>
+
+namespace openrasp
+{
+
+void BlobWriter::write_raw(const void *source, size_t num)
+{
+    buffer.append(static_cast<const char *>(source), num);
+}
+
+void BlobWriter::write_int64(int64_t value)
+{
+    write_raw(&value, sizeof(value));
+}
+
+void BlobWriter::write_bool(bool value)
+{
+    char c = value ? 1 : 0;
+    write_raw(&c, sizeof(c));
+}
+
+void BlobWriter::write_string(const std::string &value)
+{
+    uint32_t len = value.length();
+    write_raw(&len, sizeof(len));
+    write_raw(value.data(), len);
+}
+
+void BlobWriter::write_strings(const std::vector<std::string> &value)
+{
+    uint32_t count = value.size();
+    write_raw(&count, sizeof(count));
+    for (const std::string &item : value)
+    {
+        write_string(item);
+    }
+}
+
+const std::string &BlobWriter::data() const
+{
+    return buffer;
+}
+
+BlobReader::BlobReader(const char *data, size_t size)
+    : data(data), size(size)
+{
+}
+
+bool BlobReader::read_raw(void *dest, size_t num)
+{
+    if (nullptr == data || num > size - offset)
+    {
+        return false;
+    }
+    memcpy(dest, data + offset, num);
+    offset += num;
+    return true;
+}
+
+bool BlobReader::read_int64(int64_t &value)
+{
+    return read_raw(&value, sizeof(value));
+}
+
+bool BlobReader::read_bool(bool &value)
+{
+    char c = 0;
+    if (!read_raw(&c, sizeof(c)))
+    {
+        return false;
+    }
+    value = (c != 0);
+    return true;
+}
+
+bool BlobReader::read_string(std::string &value)
+{
+    uint32_t len = 0;
+    if (!read_raw(&len, sizeof(len)) || len > size - offset)
+    {
+        return false;
+    }
+    value.assign(data + offset, len);
+    offset += len;
+    return true;
+}
+
+bool BlobReader::read_strings(std::vector<std::string> &value)
+{
+    uint32_t count = 0;
+    if (!read_raw(&count, sizeof(count)))
+    {
+        return false;
+    }
+    value.clear();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        std::string item;
+        if (!read_string(item))
+        {
+            return false;
+        }
+        value.push_back(std::move(item));
+    }
+    return true;
+}
+
+bool BlobReader::eof() const
+{
+    return offset == size;
+}
+
+} // namespace openrasp
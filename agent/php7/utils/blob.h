@@ -0,0 +1,64 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _OPENRASP_UTILS_BLOB_H_
+#define _OPENRASP_UTILS_BLOB_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace openrasp
+{
+
+/**
+ * Flat binary encoding in host byte order, used to hand over pre-parsed data between processes.
+ * Values are written and read back in the same order, there are no keys.
+ */
+class BlobWriter
+{
+public:
+  void write_int64(int64_t value);
+  void write_bool(bool value);
+  void write_string(const std::string &value);
+  void write_strings(const std::vector<std::string> &value);
+  const std::string &data() const;
+
+private:
+  std::string buffer;
+  void write_raw(const void *source, size_t num);
+};
+
+class BlobReader
+{
+public:
+  BlobReader(const char *data, size_t size);
+  bool read_int64(int64_t &value);
+  bool read_bool(bool &value);
+  bool read_string(std::string &value);
+  bool read_strings(std::vector<std::string> &value);
+  bool eof() const;
+
+private:
+  const char *data;
+  size_t size;
+  size_t offset = 0;
+  bool read_raw(void *dest, size_t num);
+};
+
+} // namespace openrasp
+
+#endif
@@ -0,0 +1,302 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compact_double_array_trie.h"
+#include "digest.h"
+#include <algorithm>
+#include <cstring>
+
+namespace openrasp
+{
+
+namespace
+{
+
+struct TrieEntry
+{
+  const std::string *key;
+  uint32_t value;
+};
+
+struct TrieSibling
+{
+  uint32_t code;
+  size_t left;
+  size_t right;
+};
+
+/**
+ * Empty slots are chained in a circular doubly linked list, so looking for a base only visits
+ * free slots, and the arrays grow geometrically instead of being copied on every resize.
+ * Like darts-clone, slots which fall too far behind the last used one are no longer probed,
+ * which keeps the build time linear in the number of units.
+ */
+class CompactDoubleArrayBuilder
+{
+public:
+  explicit CompactDoubleArrayBuilder(const std::vector<TrieEntry> &entries)
+      : entries(entries) {}
+
+  int build(std::vector<uint32_t> &result)
+  {
+    grow(1024);
+    occupy(0);
+    int error = insert(0, 0, 0, entries.size());
+    if (error < 0)
+    {
+      return error;
+    }
+    result.assign(units.begin(), units.begin() + (max_pos + 1));
+    return 0;
+  }
+
+private:
+  static const uint32_t npos = static_cast<uint32_t>(-1);
+  static const size_t probe_window = 4096;
+  const std::vector<TrieEntry> &entries;
+  std::vector<uint32_t> units;
+  std::vector<char> occupied;
+  std::vector<char> used_base;
+  std::vector<uint32_t> next_free;
+  std::vector<uint32_t> prev_free;
+  uint32_t free_head = npos;
+  size_t max_pos = 0;
+
+  void grow(size_t min_size)
+  {
+    size_t old_size = units.size();
+    if (min_size <= old_size)
+    {
+      return;
+    }
+    size_t new_size = std::max(min_size, old_size * 2);
+    units.resize(new_size, 0);
+    occupied.resize(new_size, 0);
+    used_base.resize(new_size, 0);
+    next_free.resize(new_size, npos);
+    prev_free.resize(new_size, npos);
+    for (size_t i = old_size; i < new_size; ++i)
+    {
+      if (free_head == npos)
+      {
+        free_head = i;
+        next_free[i] = prev_free[i] = i;
+      }
+      else
+      {
+        uint32_t tail = prev_free[free_head];
+        next_free[tail] = i;
+        prev_free[i] = tail;
+        next_free[i] = free_head;
+        prev_free[free_head] = i;
+      }
+    }
+  }
+
+  void unlink(size_t pos)
+  {
+    if (next_free[pos] == pos)
+    {
+      free_head = npos;
+    }
+    else
+    {
+      next_free[prev_free[pos]] = next_free[pos];
+      prev_free[next_free[pos]] = prev_free[pos];
+      if (free_head == pos)
+      {
+        free_head = next_free[pos];
+      }
+    }
+  }
+
+  void occupy(size_t pos)
+  {
+    unlink(pos);
+    occupied[pos] = 1;
+    max_pos = std::max(max_pos, pos);
+  }
+
+  bool fits(size_t begin, const std::vector<TrieSibling> &siblings) const
+  {
+    if (begin < units.size() && used_base[begin])
+    {
+      return false;
+    }
+    for (const TrieSibling &sibling : siblings)
+    {
+      size_t pos = begin + sibling.code;
+      if (pos < units.size() && occupied[pos])
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  size_t find_base(const std::vector<TrieSibling> &siblings)
+  {
+    while (free_head != npos && free_head + probe_window < max_pos)
+    {
+      unlink(free_head);
+    }
+    uint32_t first_code = siblings.front().code;
+    if (free_head != npos)
+    {
+      uint32_t pos = free_head;
+      do
+      {
+        if (pos >= first_code && fits(pos - first_code, siblings))
+        {
+          return pos - first_code;
+        }
+        pos = next_free[pos];
+      } while (pos != free_head);
+    }
+    return units.size();
+  }
+
+  int insert(size_t node, size_t depth, size_t left, size_t right)
+  {
+    std::vector<TrieSibling> siblings;
+    for (size_t i = left; i < right; ++i)
+    {
+      const std::string &key = *entries[i].key;
+      uint32_t code = (key.length() == depth) ? 0 : static_cast<unsigned char>(key[depth]) + 1;
+      if (siblings.empty() || siblings.back().code != code)
+      {
+        siblings.push_back({code, i, i + 1});
+      }
+      else
+      {
+        siblings.back().right = i + 1;
+      }
+    }
+    if (siblings.empty())
+    {
+      return 0;
+    }
+    size_t begin = find_base(siblings);
+    if (begin > CompactDoubleArrayTrie::MAX_BASE)
+    {
+      return -5;
+    }
+    grow(begin + siblings.back().code + 1);
+    used_base[begin] = 1;
+    bool leaf = (siblings.front().code == 0);
+    units[node] |= (static_cast<uint32_t>(begin) << 10) | (leaf ? (1U << 9) : 0);
+    for (const TrieSibling &sibling : siblings)
+    {
+      size_t pos = begin + sibling.code;
+      occupy(pos);
+      units[pos] = (sibling.code == 0) ? (0x80000000U | entries[sibling.left].value) : sibling.code;
+    }
+    for (const TrieSibling &sibling : siblings)
+    {
+      if (sibling.code != 0)
+      {
+        int error = insert(begin + sibling.code, depth + 1, sibling.left, sibling.right);
+        if (error < 0)
+        {
+          return error;
+        }
+      }
+    }
+    return 0;
+  }
+};
+
+const uint32_t CompactDoubleArrayBuilder::npos;
+const size_t CompactDoubleArrayBuilder::probe_window;
+
+} // namespace
+
+int CompactDoubleArrayTrie::build(const std::vector<std::string> &keys, const std::vector<int64_t> *values)
+{
+  if (values && values->size() != keys.size())
+  {
+    return -1;
+  }
+  std::vector<TrieEntry> entries;
+  entries.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+  {
+    int64_t value = values ? values->at(i) : i;
+    if (value < 0 || value > MAX_VALUE)
+    {
+      return -2;
+    }
+    entries.push_back({&keys[i], static_cast<uint32_t>(value)});
+  }
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const TrieEntry &a, const TrieEntry &b) { return *a.key < *b.key; });
+  entries.erase(std::unique(entries.begin(), entries.end(),
+                            [](const TrieEntry &a, const TrieEntry &b) { return *a.key == *b.key; }),
+                entries.end());
+
+  std::vector<uint32_t> trie_units;
+  CompactDoubleArrayBuilder builder(entries);
+  int error = builder.build(trie_units);
+  if (error < 0)
+  {
+    return error;
+  }
+
+  const size_t header_units = sizeof(Header) / sizeof(unit_type);
+  buffer.assign(header_units, 0);
+  buffer.insert(buffer.end(), trie_units.begin(), trie_units.end());
+  Header header;
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.unit_count = trie_units.size();
+  header.checksum = crc32sum(trie_units.data(), trie_units.size() * sizeof(unit_type));
+  memcpy(buffer.data(), &header, sizeof(header));
+  units = buffer.data() + header_units;
+  unit_count = header.unit_count;
+  checksum = header.checksum;
+  return 0;
+}
+
+bool CompactDoubleArrayTrie::set_array(const void *ptr, size_t size)
+{
+  buffer.clear();
+  units = nullptr;
+  unit_count = 0;
+  checksum = 0;
+  if (nullptr == ptr || size < sizeof(Header))
+  {
+    return false;
+  }
+  Header header;
+  memcpy(&header, ptr, sizeof(header));
+  if (header.magic != MAGIC ||
+      header.version != VERSION ||
+      serialized_size(header.unit_count) > size)
+  {
+    return false;
+  }
+  units = reinterpret_cast<const unit_type *>(static_cast<const char *>(ptr) + sizeof(Header));
+  unit_count = header.unit_count;
+  checksum = header.checksum;
+  return true;
+}
+
+bool CompactDoubleArrayTrie::verify() const
+{
+  return nullptr != units && crc32sum(units, unit_count * sizeof(unit_type)) == checksum;
+}
+
+} // namespace openrasp
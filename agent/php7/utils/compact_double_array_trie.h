@@ -0,0 +1,181 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _OPENRASP_UTILS_COMPACT_DOUBLE_ARRAY_TRIE_H_
+#define _OPENRASP_UTILS_COMPACT_DOUBLE_ARRAY_TRIE_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace openrasp
+{
+
+/**
+ * Double array trie with packed 32-bit units and a self-describing serialized form,
+ * so that it can be built once and searched in place from shared memory.
+ *
+ * unit layout:
+ *   leaf:     [31] 1 | [0, 30] value
+ *   non-leaf: [31] 0 | [10, 30] base | [9] has leaf | [0, 8] label (byte + 1)
+ *
+ * Every base is owned by exactly one parent, so the label is enough to verify a transition.
+ * Search functions never allocate, matched keys are reported through a visitor.
+ */
+class CompactDoubleArrayTrie
+{
+public:
+  typedef uint32_t unit_type;
+  typedef uint32_t value_type;
+
+  struct Header
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t unit_count;
+    uint32_t checksum;
+  };
+
+  static const uint32_t MAGIC = 0x32544144; // "DAT2"
+  static const uint32_t VERSION = 1;
+  static const value_type MAX_VALUE = 0x7FFFFFFF;
+  static const uint32_t MAX_BASE = 0x1FFFFF;
+
+  static constexpr size_t unit_size() { return sizeof(unit_type); }
+  static constexpr size_t serialized_size(size_t unit_count) { return sizeof(Header) + unit_count * sizeof(unit_type); }
+
+  CompactDoubleArrayTrie() = default;
+  CompactDoubleArrayTrie(const CompactDoubleArrayTrie &) = delete;
+  CompactDoubleArrayTrie &operator=(const CompactDoubleArrayTrie &) = delete;
+
+  /**
+   * keys do not need to be sorted, duplicated keys keep the value of the first one.
+   * values must be in [0, MAX_VALUE], key index is used as value if values is nullptr.
+   * @return 0 on success, negative on error
+   */
+  int build(const std::vector<std::string> &keys, const std::vector<int64_t> *values = nullptr);
+
+  /**
+   * attach to serialized data (eg. in shared memory) without copying it,
+   * only the header is validated here, call verify() for the checksum.
+   */
+  bool set_array(const void *ptr, size_t size);
+  bool verify() const;
+
+  const void *array() const { return buffer.empty() ? nullptr : buffer.data(); }
+  size_t total_size() const { return buffer.size() * sizeof(unit_type); }
+  size_t size() const { return unit_count; }
+
+  /**
+   * @param fold_len the first fold_len bytes of key are matched ASCII case-insensitively,
+   *                 the corresponding part of the keys must have been built in lower case.
+   */
+  bool exact_match(const char *key, size_t len, value_type &value, size_t fold_len = 0) const
+  {
+    size_t node = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+      if (!transit(node, fold(key[i], i < fold_len)))
+      {
+        return false;
+      }
+    }
+    return leaf_value(node, value);
+  }
+
+  /**
+   * visitor is called as visitor(value, length) for every key which is a prefix of the given key,
+   * in ascending order of length.
+   * @return number of matched keys
+   */
+  template <typename Visitor>
+  size_t common_prefix_search(const char *key, size_t len, Visitor visitor, size_t fold_len = 0) const
+  {
+    size_t num = 0;
+    size_t node = 0;
+    value_type value;
+    for (size_t i = 0; i < len; ++i)
+    {
+      if (leaf_value(node, value))
+      {
+        visitor(value, i);
+        ++num;
+      }
+      if (!transit(node, fold(key[i], i < fold_len)))
+      {
+        return num;
+      }
+    }
+    if (leaf_value(node, value))
+    {
+      visitor(value, len);
+      ++num;
+    }
+    return num;
+  }
+
+private:
+  std::vector<unit_type> buffer;
+  const unit_type *units = nullptr;
+  size_t unit_count = 0;
+  uint32_t checksum = 0;
+
+  static inline bool is_leaf(unit_type unit) { return (unit >> 31) != 0; }
+  static inline bool has_leaf(unit_type unit) { return ((unit >> 9) & 1) != 0; }
+  static inline uint32_t label(unit_type unit) { return unit & 0x1FF; }
+  static inline uint32_t base(unit_type unit) { return (unit >> 10) & MAX_BASE; }
+
+  static inline unsigned char fold(char c, bool ignore_case)
+  {
+    unsigned char uc = static_cast<unsigned char>(c);
+    return (ignore_case && uc >= 'A' && uc <= 'Z') ? uc + ('a' - 'A') : uc;
+  }
+
+  inline bool transit(size_t &node, unsigned char c) const
+  {
+    if (node >= unit_count)
+    {
+      return false;
+    }
+    size_t next = base(units[node]) + c + 1;
+    if (next >= unit_count || is_leaf(units[next]) || label(units[next]) != static_cast<uint32_t>(c) + 1)
+    {
+      return false;
+    }
+    node = next;
+    return true;
+  }
+
+  inline bool leaf_value(size_t node, value_type &value) const
+  {
+    if (node >= unit_count || !has_leaf(units[node]))
+    {
+      return false;
+    }
+    size_t leaf = base(units[node]);
+    if (leaf >= unit_count || !is_leaf(units[leaf]))
+    {
+      return false;
+    }
+    value = units[leaf] & MAX_VALUE;
+    return true;
+  }
+};
+
+} // namespace openrasp
+
+#endif
@@ -344,4 +344,34 @@ void md5bin(const void *dat, size_t len, unsigned char out[100])
     MD5_Final(out, &c);
 }
 
+struct Crc32Table
+{
+    uint32_t value[256];
+    Crc32Table()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+            {
+                c = (c & 1) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+            }
+            value[i] = c;
+        }
+    }
+};
+
+uint32_t crc32sum(const void *dat, size_t len, uint32_t crc)
+{
+    static const Crc32Table crc32_table;
+    const uint32_t *table = crc32_table.value;
+    const unsigned char *p = static_cast<const unsigned char *>(dat);
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i)
+    {
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
 } // namespace openrasp
@@ -18,6 +18,7 @@
 #define _OPENRASP_AGENT_UTILS_DIGEST_H_
 
 #include <string>
+#include <cstdint>
 namespace openrasp
 {
 
@@ -32,6 +33,12 @@ std::string md5sum(const void *dat, size_t len);
  */
 void md5bin(const void *dat, size_t len, unsigned char out[16]);
 
+/**
+ * CRC-32 (IEEE 802.3), same as zlib crc32 and PHP crc32().
+ * @crc Previous result for incremental calculation, 0 for the first block.
+ */
+uint32_t crc32sum(const void *dat, size_t len, uint32_t crc = 0);
+
 } // namespace openrasp
 
 #endif
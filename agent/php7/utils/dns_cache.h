@@ -0,0 +1,106 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <functional>
+#include <time.h>
+
+namespace openrasp
+{
+
+/**
+ * Direct mapped host -> addresses table with expiration, an empty address list is a cached failure.
+ *
+ * Only fixed size arrays are used, a zero filled DnsCache placed in shared memory is valid,
+ * callers are responsible for locking.
+ */
+class DnsCache
+{
+public:
+  static const size_t max_entries = 256;
+  static const size_t max_host_length = 253;
+  static const size_t max_ips = 8;
+  static const size_t max_ip_length = 46;
+
+  bool get(const std::string &host, time_t now, std::vector<std::string> &ips) const
+  {
+    const Entry &entry = entries[slot(host)];
+    if (entry.expire <= now ||
+        entry.host_length != host.length() ||
+        0 != memcmp(entry.host, host.c_str(), host.length()))
+    {
+      return false;
+    }
+    ips.clear();
+    for (size_t i = 0; i < entry.ip_count; ++i)
+    {
+      ips.push_back(entry.ips[i]);
+    }
+    return true;
+  }
+
+  /**
+   * hosts or address lists too large for an entry are not cached, a truncated list would hide addresses
+   */
+  bool set(const std::string &host, const std::vector<std::string> &ips, time_t expire)
+  {
+    if (host.empty() || host.length() > max_host_length || ips.size() > max_ips)
+    {
+      return false;
+    }
+    for (auto &ip : ips)
+    {
+      if (ip.length() >= max_ip_length)
+      {
+        return false;
+      }
+    }
+    Entry &entry = entries[slot(host)];
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.host, host.c_str(), host.length());
+    entry.host_length = host.length();
+    for (size_t i = 0; i < ips.size(); ++i)
+    {
+      memcpy(entry.ips[i], ips[i].c_str(), ips[i].length());
+    }
+    entry.ip_count = ips.size();
+    entry.expire = expire;
+    return true;
+  }
+
+private:
+  struct Entry
+  {
+    time_t expire;
+    size_t host_length;
+    size_t ip_count;
+    char host[max_host_length + 1];
+    char ips[max_ips][max_ip_length];
+  };
+
+  Entry entries[max_entries];
+
+  static size_t slot(const std::string &host)
+  {
+    return std::hash<std::string>()(host) % max_entries;
+  }
+};
+
+} // namespace openrasp
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <time.h>
+
+namespace openrasp
+{
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "LoadEstimator lives in shared memory and needs lock-free 64 bit atomics");
+
+/**
+ * Busy time reported by every worker, summed per second.
+ *
+ * The total of the last complete second is the load, a zero filled LoadEstimator placed in
+ * shared memory is shared by every worker process without locks. Reports racing with the turn
+ * of a second may land in either second, the estimate does not need to be exact.
+ */
+class LoadEstimator
+{
+public:
+  void add(int64_t micros, time_t now)
+  {
+    roll(now);
+    current.fetch_add(micros, std::memory_order_relaxed);
+  }
+
+  /**
+   * @return busy microseconds in the last complete second, 0 if nothing was reported in it
+   */
+  int64_t load(time_t now)
+  {
+    roll(now);
+    return last.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<int64_t> second;
+  std::atomic<int64_t> current;
+  std::atomic<int64_t> last;
+
+  void roll(time_t now)
+  {
+    int64_t previous = second.load(std::memory_order_relaxed);
+    if (previous != now && second.compare_exchange_strong(previous, now, std::memory_order_relaxed))
+    {
+      int64_t total = current.exchange(0, std::memory_order_relaxed);
+      last.store(previous == now - 1 ? total : 0, std::memory_order_relaxed);
+    }
+  }
+};
+
+} // namespace openrasp
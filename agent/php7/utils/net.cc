@@ -253,10 +253,27 @@ bool fetch_source_in_ip_packets(char *local_ip, size_t len, char *url)
     return false;
 }
 
-std::vector<std::string> lookup_host(const std::string &host)
+static bool normalize_ip_literal(const std::string &host, std::string &ip)
 {
-    std::vector<std::string> ips;
-    struct addrinfo hints, *res;
+    unsigned char addr[sizeof(struct in6_addr)];
+    char addrstr[INET6_ADDRSTRLEN];
+    int family = host.find(':') != std::string::npos ? AF_INET6 : AF_INET;
+    if (inet_pton(family, host.c_str(), addr) == 1 &&
+        inet_ntop(family, addr, addrstr, sizeof(addrstr)) != nullptr)
+    {
+        ip = addrstr;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @return false if the resolver failed to answer, a host that does not exist is an answer
+ */
+static bool resolve_host(const std::string &host, std::vector<std::string> &ips)
+{
+    ips.clear();
+    struct addrinfo hints, *res, *cur;
     int errcode;
     char addrstr[100];
     void *ptr;
@@ -269,26 +286,44 @@ std::vector<std::string> lookup_host(const std::string &host)
     errcode = getaddrinfo(host.c_str(), nullptr, &hints, &res);
     if (errcode == 0)
     {
-        while (res)
+        for (cur = res; cur; cur = cur->ai_next)
         {
-            inet_ntop(res->ai_family, res->ai_addr->sa_data, addrstr, 100);
-
-            switch (res->ai_family)
+            switch (cur->ai_family)
             {
             case AF_INET:
-                ptr = &((struct sockaddr_in *)res->ai_addr)->sin_addr;
+                ptr = &((struct sockaddr_in *)cur->ai_addr)->sin_addr;
                 break;
             case AF_INET6:
-                ptr = &((struct sockaddr_in6 *)res->ai_addr)->sin6_addr;
+                ptr = &((struct sockaddr_in6 *)cur->ai_addr)->sin6_addr;
                 break;
+            default:
+                continue;
             }
-            inet_ntop(res->ai_family, ptr, addrstr, 100);
+            inet_ntop(cur->ai_family, ptr, addrstr, 100);
             ips.push_back(addrstr);
-            res = res->ai_next;
         }
+        freeaddrinfo(res);
     }
     std::sort(ips.begin(), ips.end());
+    return errcode == 0 || errcode == EAI_NONAME;
+}
+
+std::vector<std::string> lookup_host(const std::string &host)
+{
+    std::vector<std::string> ips;
+    lookup_host(host, ips);
     return ips;
 }
 
+bool lookup_host(const std::string &host, std::vector<std::string> &ips)
+{
+    std::string ip;
+    if (normalize_ip_literal(host, ip))
+    {
+        ips = {ip};
+        return true;
+    }
+    return resolve_host(host, ips);
+}
+
 } // namespace openrasp
@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
 
 namespace openrasp
 {
@@ -28,6 +29,11 @@ void fetch_if_addrs(std::map<std::string, std::string> &if_addr_map);
 void fetch_hw_addrs(std::vector<std::string> &hw_addrs);
 bool fetch_source_in_ip_packets(char *local_ip, size_t len, char *url);
 std::vector<std::string> lookup_host(const std::string &host);
+/**
+ * ip literals are returned as is without resolving
+ * @return false if the resolver failed to answer, a host that does not exist is an answer
+ */
+bool lookup_host(const std::string &host, std::vector<std::string> &ips);
 
 } // namespace openrasp
 
@@ -16,36 +16,916 @@
 
 #include "regex.h"
 #include <regex>
+#include <map>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <bitset>
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
 
 namespace openrasp
 {
 
-bool regex_match(const char *str, const char *regex)
+namespace
+{
+
+typedef std::bitset<256> ByteSet;
+
+struct Node
+{
+    enum Type
+    {
+        SET,
+        CAT,
+        ALT,
+        REPEAT,
+        BOL,
+        EOL
+    };
+    Type type;
+    ByteSet set;
+    std::vector<std::unique_ptr<Node>> children;
+    int min = 0;
+    int max = -1;
+
+    explicit Node(Type type) : type(type) {}
+};
+
+/**
+ * Recursive descent parser for the ECMAScript subset the DFA can run:
+ * literals, escapes, classes, '.', groups, '|', '^', '$' and all quantifiers.
+ * Anything else makes parse() fail so that the caller falls back to std::regex.
+ */
+class Parser
+{
+public:
+    static const int max_depth = 64;
+    static const int max_repeat = 256;
+
+    explicit Parser(const std::string &pattern) : pattern(pattern) {}
+
+    std::unique_ptr<Node> parse()
+    {
+        std::unique_ptr<Node> node = parse_alt(0);
+        if (!node || pos != pattern.length())
+        {
+            return nullptr;
+        }
+        return node;
+    }
+
+private:
+    const std::string &pattern;
+    size_t pos = 0;
+
+    bool eof() const { return pos >= pattern.length(); }
+    char peek() const { return pattern[pos]; }
+
+    std::unique_ptr<Node> parse_alt(int depth)
+    {
+        if (depth > max_depth)
+        {
+            return nullptr;
+        }
+        std::unique_ptr<Node> alt(new Node(Node::ALT));
+        while (true)
+        {
+            std::unique_ptr<Node> cat = parse_cat(depth);
+            if (!cat)
+            {
+                return nullptr;
+            }
+            alt->children.push_back(std::move(cat));
+            if (eof() || peek() != '|')
+            {
+                break;
+            }
+            ++pos;
+        }
+        if (alt->children.size() == 1)
+        {
+            return std::move(alt->children[0]);
+        }
+        return alt;
+    }
+
+    std::unique_ptr<Node> parse_cat(int depth)
+    {
+        std::unique_ptr<Node> cat(new Node(Node::CAT));
+        while (!eof() && peek() != '|' && peek() != ')')
+        {
+            std::unique_ptr<Node> atom = parse_atom(depth);
+            if (!atom || !parse_quantifier(atom))
+            {
+                return nullptr;
+            }
+            cat->children.push_back(std::move(atom));
+        }
+        return cat;
+    }
+
+    std::unique_ptr<Node> parse_atom(int depth)
+    {
+        char c = pattern[pos++];
+        std::unique_ptr<Node> node;
+        switch (c)
+        {
+        case '^':
+            return std::unique_ptr<Node>(new Node(Node::BOL));
+        case '$':
+            return std::unique_ptr<Node>(new Node(Node::EOL));
+        case '(':
+            if (!eof() && peek() == '?')
+            {
+                if (pattern.compare(pos, 2, "?:") != 0)
+                {
+                    return nullptr;
+                }
+                pos += 2;
+            }
+            node = parse_alt(depth + 1);
+            if (!node || eof() || peek() != ')')
+            {
+                return nullptr;
+            }
+            ++pos;
+            return node;
+        case '[':
+            return parse_class();
+        case '.':
+            node.reset(new Node(Node::SET));
+            node->set.set();
+            node->set.reset('\n');
+            node->set.reset('\r');
+            return node;
+        case '\\':
+            node.reset(new Node(Node::SET));
+            if (!parse_escape(node->set, false))
+            {
+                return nullptr;
+            }
+            return node;
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+        case '}':
+        case ']':
+        case ')':
+            return nullptr;
+        default:
+            node.reset(new Node(Node::SET));
+            node->set.set(static_cast<unsigned char>(c));
+            return node;
+        }
+    }
+
+    bool parse_number(int &value)
+    {
+        size_t start = pos;
+        value = 0;
+        while (!eof() && isdigit(static_cast<unsigned char>(peek())))
+        {
+            value = value * 10 + (peek() - '0');
+            if (value > max_repeat)
+            {
+                return false;
+            }
+            ++pos;
+        }
+        return pos > start;
+    }
+
+    bool parse_quantifier(std::unique_ptr<Node> &atom)
+    {
+        if (eof())
+        {
+            return true;
+        }
+        int min = 0;
+        int max = -1;
+        switch (peek())
+        {
+        case '*':
+            ++pos;
+            break;
+        case '+':
+            ++pos;
+            min = 1;
+            break;
+        case '?':
+            ++pos;
+            max = 1;
+            break;
+        case '{':
+            ++pos;
+            if (!parse_number(min))
+            {
+                return false;
+            }
+            max = min;
+            if (!eof() && peek() == ',')
+            {
+                ++pos;
+                max = -1;
+                if (!eof() && peek() != '}' && (!parse_number(max) || max < min))
+                {
+                    return false;
+                }
+            }
+            if (eof() || peek() != '}')
+            {
+                return false;
+            }
+            ++pos;
+            break;
+        default:
+            return true;
+        }
+        if (atom->type == Node::BOL || atom->type == Node::EOL)
+        {
+            return false;
+        }
+        // lazy quantifiers accept the same language
+        if (!eof() && peek() == '?')
+        {
+            ++pos;
+        }
+        if (!eof() && (peek() == '*' || peek() == '+' || peek() == '?' || peek() == '{'))
+        {
+            return false;
+        }
+        std::unique_ptr<Node> repeat(new Node(Node::REPEAT));
+        repeat->min = min;
+        repeat->max = max;
+        repeat->children.push_back(std::move(atom));
+        atom = std::move(repeat);
+        return true;
+    }
+
+    static int hex_value(char c)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f')
+        {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F')
+        {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+
+    /**
+     * Parse the escape following a backslash into set.
+     * @return false for escapes the DFA can not express (backreferences, \b, \B, \c, \u).
+     */
+    bool parse_escape(ByteSet &set, bool in_class)
+    {
+        if (eof())
+        {
+            return false;
+        }
+        char c = pattern[pos++];
+        ByteSet tmp;
+        switch (c)
+        {
+        case 'd':
+        case 'D':
+            for (int i = '0'; i <= '9'; ++i)
+            {
+                tmp.set(i);
+            }
+            break;
+        case 'w':
+        case 'W':
+            for (int i = 0; i < 256; ++i)
+            {
+                if (isalnum(i) || i == '_')
+                {
+                    tmp.set(i);
+                }
+            }
+            break;
+        case 's':
+        case 'S':
+            for (const char *p = " \t\n\v\f\r"; *p; ++p)
+            {
+                tmp.set(static_cast<unsigned char>(*p));
+            }
+            break;
+        case 't':
+            set.set('\t');
+            return true;
+        case 'n':
+            set.set('\n');
+            return true;
+        case 'r':
+            set.set('\r');
+            return true;
+        case 'f':
+            set.set('\f');
+            return true;
+        case 'v':
+            set.set('\v');
+            return true;
+        case '0':
+            if (!eof() && isdigit(static_cast<unsigned char>(peek())))
+            {
+                return false;
+            }
+            set.set(0);
+            return true;
+        case 'x':
+        {
+            if (pos + 2 > pattern.length() || hex_value(pattern[pos]) < 0 || hex_value(pattern[pos + 1]) < 0)
+            {
+                return false;
+            }
+            set.set(hex_value(pattern[pos]) * 16 + hex_value(pattern[pos + 1]));
+            pos += 2;
+            return true;
+        }
+        case 'b':
+            if (!in_class)
+            {
+                return false;
+            }
+            set.set('\b');
+            return true;
+        case 'B':
+        case 'c':
+        case 'u':
+            return false;
+        default:
+            if (isalnum(static_cast<unsigned char>(c)))
+            {
+                return false;
+            }
+            set.set(static_cast<unsigned char>(c));
+            return true;
+        }
+        set |= isupper(static_cast<unsigned char>(c)) ? ~tmp : tmp;
+        return true;
+    }
+
+    /**
+     * Parse a single class member, single characters are reported through ch for ranges.
+     */
+    bool parse_class_atom(ByteSet &set, int &ch)
+    {
+        char c = pattern[pos++];
+        ch = -1;
+        if (c == '\\')
+        {
+            ByteSet tmp;
+            if (!parse_escape(tmp, true))
+            {
+                return false;
+            }
+            if (tmp.count() == 1)
+            {
+                for (int i = 0; i < 256; ++i)
+                {
+                    if (tmp.test(i))
+                    {
+                        ch = i;
+                    }
+                }
+            }
+            set |= tmp;
+            return true;
+        }
+        if (c == '[' && !eof() && (peek() == ':' || peek() == '.' || peek() == '='))
+        {
+            return false;
+        }
+        ch = static_cast<unsigned char>(c);
+        set.set(ch);
+        return true;
+    }
+
+    std::unique_ptr<Node> parse_class()
+    {
+        std::unique_ptr<Node> node(new Node(Node::SET));
+        bool negate = false;
+        if (!eof() && peek() == '^')
+        {
+            negate = true;
+            ++pos;
+        }
+        if (!eof() && peek() == ']')
+        {
+            return nullptr;
+        }
+        ByteSet set;
+        while (!eof() && peek() != ']')
+        {
+            int low = -1;
+            if (!parse_class_atom(set, low))
+            {
+                return nullptr;
+            }
+            if (pos + 1 < pattern.length() && peek() == '-' && pattern[pos + 1] != ']')
+            {
+                ++pos;
+                int high = -1;
+                if (low < 0 || !parse_class_atom(set, high) || high < low)
+                {
+                    return nullptr;
+                }
+                for (int i = low; i <= high; ++i)
+                {
+                    set.set(i);
+                }
+            }
+        }
+        if (eof())
+        {
+            return nullptr;
+        }
+        ++pos;
+        node->set = negate ? ~set : set;
+        return node;
+    }
+};
+
+struct Inst
+{
+    enum Op
+    {
+        SET,
+        SPLIT,
+        JMP,
+        BOL,
+        EOL,
+        MATCH
+    };
+    Op op;
+    int x = 0;
+    int y = 0;
+    ByteSet set;
+
+    explicit Inst(Op op) : op(op) {}
+};
+
+/**
+ * Thompson construction of the AST, bounded repetitions are unrolled.
+ */
+class Compiler
+{
+public:
+    static const size_t max_insts = 4096;
+
+    bool compile(const Node *root, std::vector<Inst> &out)
+    {
+        if (!emit(root))
+        {
+            return false;
+        }
+        insts.push_back(Inst(Inst::MATCH));
+        out.swap(insts);
+        return true;
+    }
+
+private:
+    std::vector<Inst> insts;
+
+    int add(Inst::Op op)
+    {
+        insts.push_back(Inst(op));
+        return insts.size() - 1;
+    }
+
+    bool emit(const Node *node)
+    {
+        if (insts.size() > max_insts)
+        {
+            return false;
+        }
+        switch (node->type)
+        {
+        case Node::SET:
+        {
+            int pc = add(Inst::SET);
+            insts[pc].set = node->set;
+            insts[pc].x = pc + 1;
+            return true;
+        }
+        case Node::BOL:
+        {
+            int pc = add(Inst::BOL);
+            insts[pc].x = pc + 1;
+            return true;
+        }
+        case Node::EOL:
+        {
+            int pc = add(Inst::EOL);
+            insts[pc].x = pc + 1;
+            return true;
+        }
+        case Node::CAT:
+            for (auto &child : node->children)
+            {
+                if (!emit(child.get()))
+                {
+                    return false;
+                }
+            }
+            return true;
+        case Node::ALT:
+        {
+            std::vector<int> jumps;
+            for (size_t i = 0; i < node->children.size(); ++i)
+            {
+                int split = -1;
+                if (i + 1 < node->children.size())
+                {
+                    split = add(Inst::SPLIT);
+                    insts[split].x = split + 1;
+                }
+                if (!emit(node->children[i].get()))
+                {
+                    return false;
+                }
+                if (split >= 0)
+                {
+                    jumps.push_back(add(Inst::JMP));
+                    insts[split].y = insts.size();
+                }
+            }
+            for (int jump : jumps)
+            {
+                insts[jump].x = insts.size();
+            }
+            return true;
+        }
+        case Node::REPEAT:
+        {
+            const Node *child = node->children[0].get();
+            for (int i = 0; i < node->min; ++i)
+            {
+                if (!emit(child))
+                {
+                    return false;
+                }
+            }
+            if (node->max < 0)
+            {
+                int split = add(Inst::SPLIT);
+                insts[split].x = split + 1;
+                if (!emit(child))
+                {
+                    return false;
+                }
+                insts[add(Inst::JMP)].x = split;
+                insts[split].y = insts.size();
+                return true;
+            }
+            std::vector<int> splits;
+            for (int i = node->min; i < node->max; ++i)
+            {
+                int split = add(Inst::SPLIT);
+                insts[split].x = split + 1;
+                splits.push_back(split);
+                if (!emit(child))
+                {
+                    return false;
+                }
+            }
+            for (int split : splits)
+            {
+                insts[split].y = insts.size();
+            }
+            return true;
+        }
+        }
+        return false;
+    }
+};
+
+/**
+ * RE2 style lazy DFA: every state is the epsilon closure of a set of NFA threads,
+ * transitions are computed on first use and memoized, so matching is linear in the
+ * input and allocation free once the reachable states are built.
+ */
+class LazyDfa
 {
+public:
+    static const size_t max_states = 256;
+
+    LazyDfa(const std::vector<Inst> &insts, bool unanchored)
+        : insts(insts), unanchored(unanchored), visited(insts.size(), 0) {}
+
+    bool run(const unsigned char *str, size_t len)
+    {
+        if (start < 0)
+        {
+            std::vector<int> seeds{0};
+            start = add_state(closure(seeds, true));
+        }
+        int cur = start;
+        for (size_t i = 0; i < len; ++i)
+        {
+            if (unanchored && states[cur].matched)
+            {
+                return true;
+            }
+            if (!unanchored && states[cur].pcs.empty())
+            {
+                return false;
+            }
+            int next = states[cur].next[str[i]];
+            if (next < 0)
+            {
+                next = step(cur, str[i]);
+            }
+            cur = next;
+        }
+        return states[cur].matched || end_matched(cur, 0 == len);
+    }
+
+private:
+    struct State
+    {
+        std::vector<int> pcs;
+        bool matched = false;
+        int end_matched = -1;
+        int next[256];
+    };
+
+    const std::vector<Inst> &insts;
+    const bool unanchored;
+    std::vector<State> states;
+    std::map<std::vector<int>, int> state_ids;
+    std::vector<unsigned> visited;
+    unsigned generation = 0;
+    unsigned flushes = 0;
+    int start = -1;
+
+    std::vector<int> closure(std::vector<int> &stack, bool at_begin, bool at_end = false)
+    {
+        std::vector<int> pcs;
+        if (++generation == 0)
+        {
+            std::fill(visited.begin(), visited.end(), 0);
+            generation = 1;
+        }
+        while (!stack.empty())
+        {
+            int pc = stack.back();
+            stack.pop_back();
+            if (visited[pc] == generation)
+            {
+                continue;
+            }
+            visited[pc] = generation;
+            const Inst &inst = insts[pc];
+            switch (inst.op)
+            {
+            case Inst::SET:
+            case Inst::MATCH:
+                pcs.push_back(pc);
+                break;
+            case Inst::SPLIT:
+                stack.push_back(inst.y);
+                stack.push_back(inst.x);
+                break;
+            case Inst::JMP:
+                stack.push_back(inst.x);
+                break;
+            case Inst::BOL:
+                if (at_begin)
+                {
+                    stack.push_back(inst.x);
+                }
+                break;
+            case Inst::EOL:
+                if (at_end)
+                {
+                    stack.push_back(inst.x);
+                }
+                else
+                {
+                    pcs.push_back(pc);
+                }
+                break;
+            }
+        }
+        std::sort(pcs.begin(), pcs.end());
+        return pcs;
+    }
+
+    int add_state(std::vector<int> &&pcs)
+    {
+        auto found = state_ids.find(pcs);
+        if (found != state_ids.end())
+        {
+            return found->second;
+        }
+        if (states.size() >= max_states)
+        {
+            // bound memory like RE2 does: throw the cache away and keep going
+            states.clear();
+            state_ids.clear();
+            start = -1;
+            ++flushes;
+        }
+        State state;
+        for (int pc : pcs)
+        {
+            if (insts[pc].op == Inst::MATCH)
+            {
+                state.matched = true;
+            }
+        }
+        std::fill(std::begin(state.next), std::end(state.next), -1);
+        state.pcs = pcs;
+        states.push_back(std::move(state));
+        state_ids.insert({std::move(pcs), states.size() - 1});
+        return states.size() - 1;
+    }
+
+    int step(int cur, unsigned char c)
+    {
+        std::vector<int> seeds;
+        for (int pc : states[cur].pcs)
+        {
+            if (insts[pc].op == Inst::SET && insts[pc].set.test(c))
+            {
+                seeds.push_back(insts[pc].x);
+            }
+        }
+        if (unanchored)
+        {
+            seeds.push_back(0);
+        }
+        unsigned flushed = flushes;
+        int next = add_state(closure(seeds, false));
+        if (flushed == flushes)
+        {
+            states[cur].next[c] = next;
+        }
+        return next;
+    }
+
+    bool end_matched(int cur, bool at_begin)
+    {
+        State &state = states[cur];
+        if (state.end_matched >= 0 && !at_begin)
+        {
+            return state.end_matched != 0;
+        }
+        std::vector<int> seeds;
+        for (int pc : state.pcs)
+        {
+            if (insts[pc].op == Inst::EOL)
+            {
+                seeds.push_back(pc);
+            }
+        }
+        bool matched = false;
+        if (!seeds.empty())
+        {
+            for (int pc : closure(seeds, at_begin, true))
+            {
+                if (insts[pc].op == Inst::MATCH)
+                {
+                    matched = true;
+                }
+            }
+        }
+        if (!at_begin)
+        {
+            state.end_matched = matched ? 1 : 0;
+        }
+        return matched;
+    }
+};
+
+} // namespace
+
+class CompiledRegex::Impl
+{
+public:
+    std::vector<Inst> insts;
+    std::unique_ptr<LazyDfa> matcher;
+    std::unique_ptr<LazyDfa> searcher;
+    std::unique_ptr<std::regex> fallback;
+    bool valid = false;
+};
+
+CompiledRegex::CompiledRegex(const std::string &pattern)
+    : impl(new Impl())
+{
+    std::unique_ptr<Node> root = Parser(pattern).parse();
+    if (root && Compiler().compile(root.get(), impl->insts))
+    {
+        impl->matcher.reset(new LazyDfa(impl->insts, false));
+        impl->searcher.reset(new LazyDfa(impl->insts, true));
+        impl->valid = true;
+        return;
+    }
     try
     {
-        const std::regex re(regex);
-        return std::regex_match(str, re);
+        impl->fallback.reset(new std::regex(pattern));
+        impl->valid = true;
     }
     catch (std::regex_error &e)
     {
         //skip
     }
-    return false;
 }
 
-bool regex_search(const char *str, const char *regex)
+CompiledRegex::~CompiledRegex() {}
+
+bool CompiledRegex::match(const char *str, size_t len)
 {
-    try
+    if (impl->matcher)
     {
-        const std::regex re(regex);
-        return std::regex_search(str, re);
+        return impl->matcher->run(reinterpret_cast<const unsigned char *>(str), len);
     }
-    catch (std::regex_error &e)
+    return impl->fallback && std::regex_match(str, str + len, *impl->fallback);
+}
+
+bool CompiledRegex::search(const char *str, size_t len)
+{
+    if (impl->searcher)
     {
-        //skip
+        return impl->searcher->run(reinterpret_cast<const unsigned char *>(str), len);
+    }
+    return impl->fallback && std::regex_search(str, str + len, *impl->fallback);
+}
+
+bool CompiledRegex::is_valid() const
+{
+    return impl->valid;
+}
+
+bool CompiledRegex::is_linear() const
+{
+    return impl->matcher != nullptr;
+}
+
+static std::atomic<unsigned> regex_epoch(0);
+
+static CompiledRegex &get_compiled_regex(const char *regex)
+{
+    static const size_t max_cached = 64;
+    struct RegexCache
+    {
+        unsigned epoch = 0;
+        std::unordered_map<std::string, std::unique_ptr<CompiledRegex>> entries;
+        const std::string *last_pattern = nullptr;
+        CompiledRegex *last = nullptr;
+    };
+    static thread_local RegexCache cache;
+    unsigned epoch = regex_epoch.load(std::memory_order_relaxed);
+    if (cache.epoch != epoch)
+    {
+        cache.entries.clear();
+        cache.last_pattern = nullptr;
+        cache.last = nullptr;
+        cache.epoch = epoch;
     }
-    return false;
+    // callers mostly repeat the same pattern, skip hashing for it
+    if (cache.last && *cache.last_pattern == regex)
+    {
+        return *cache.last;
+    }
+    auto found = cache.entries.find(regex);
+    if (found == cache.entries.end())
+    {
+        if (cache.entries.size() >= max_cached)
+        {
+            cache.entries.clear();
+        }
+        found = cache.entries.emplace(regex, std::unique_ptr<CompiledRegex>(new CompiledRegex(regex))).first;
+    }
+    cache.last_pattern = &found->first;
+    cache.last = found->second.get();
+    return *cache.last;
+}
+
+void regex_cache_advance_epoch()
+{
+    regex_epoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool regex_match(const char *str, const char *regex)
+{
+    return get_compiled_regex(regex).match(str, strlen(str));
+}
+
+bool regex_search(const char *str, const char *regex)
+{
+    return get_compiled_regex(regex).search(str, strlen(str));
 }
 
-} // namespace openrasp
\ No newline at end of file
+} // namespace openrasp
@@ -17,10 +17,41 @@
 #ifndef _OPENRASP_UTILS_REGEX_H_
 #define _OPENRASP_UTILS_REGEX_H_
 
+#include <string>
+#include <memory>
+
 namespace openrasp
 {
 bool regex_match(const char *str, const char *regex);
 bool regex_search(const char *str, const char *regex);
-}
 
-#endif
\ No newline at end of file
+/**
+ * Drop every compiled pattern cached by regex_match/regex_search.
+ * Called whenever plugin or config reload may replace the patterns in use,
+ * each thread flushes its cache on its next lookup.
+ */
+void regex_cache_advance_epoch();
+
+/**
+ * ECMAScript regex compiled once and matched in linear time by a lazily built DFA.
+ * Patterns outside the supported subset (backreferences, lookaround, word boundaries...)
+ * fall back to std::regex, invalid patterns never match.
+ */
+class CompiledRegex
+{
+public:
+  explicit CompiledRegex(const std::string &pattern);
+  ~CompiledRegex();
+
+  bool match(const char *str, size_t len);
+  bool search(const char *str, size_t len);
+  bool is_valid() const;
+  bool is_linear() const;
+
+private:
+  class Impl;
+  std::unique_ptr<Impl> impl;
+};
+} // namespace openrasp
+
+#endif
@@ -16,65 +16,68 @@
 
 #pragma once
 
-#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <time.h>
 
 namespace openrasp
 {
 
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Sampler lives in shared memory and needs lock-free 64 bit atomics");
+
+/**
+ * Allows at most burst checks per interval seconds, intervals are aligned to multiples of interval.
+ *
+ * The window number and the count are packed into one 64 bit word updated with compare-and-swap,
+ * so a zero filled Sampler placed in shared memory is shared by every worker process without locks.
+ */
 class Sampler
 {
 public:
-  Sampler(int interval = 0, int burst = 0)
-  {
-    update(interval, burst);
-  }
-
-  void update(int interval, int burst)
+  bool check(int interval, int burst)
   {
-    if (this->interval != interval || this->burst != burst)
-    {
-      std::lock_guard<std::mutex> lock(mtx);
-      if (this->interval != interval || this->burst != burst)
-      {
-        this->interval = interval;
-        this->burst = burst;
-        this->nextClearTime = 0;
-        this->count = 0;
-      }
-    }
+    return check(interval, burst, coarse_time());
   }
 
-  bool check()
+  bool check(int interval, int burst, time_t now)
   {
-    if (interval <= 0 || burst <= 0)
+    if (interval <= 0 || burst <= 0 || now < 0)
     {
       return false;
     }
-    time_t timestamp = time(nullptr);
-    if (timestamp >= nextClearTime)
+    uint64_t window = static_cast<uint64_t>(now / interval) & 0xffffffff;
+    uint64_t state = this->state.load(std::memory_order_relaxed);
+    while (true)
     {
-      std::lock_guard<std::mutex> lock(mtx);
-      if (timestamp >= nextClearTime)
+      uint64_t count = (state >> 32) == window ? state & 0xffffffff : 0;
+      if (count >= static_cast<uint64_t>(burst))
+      {
+        return false;
+      }
+      if (this->state.compare_exchange_weak(state, (window << 32) | (count + 1), std::memory_order_relaxed))
       {
-        count = 0;
-        nextClearTime = timestamp + interval;
-        nextClearTime -= nextClearTime % interval;
+        return true;
       }
     }
-    if (count >= burst)
+  }
+
+  /**
+   * seconds since epoch from the coarse clock, read from the vDSO without entering the kernel
+   */
+  static time_t coarse_time()
+  {
+#ifdef CLOCK_REALTIME_COARSE
+    struct timespec ts;
+    if (0 == clock_gettime(CLOCK_REALTIME_COARSE, &ts))
     {
-      return false;
+      return ts.tv_sec;
     }
-    std::lock_guard<std::mutex> lock(mtx);
-    count++;
-    return true;
+#endif
+    return time(nullptr);
   }
 
-  std::mutex mtx;
-  time_t nextClearTime = 0;
-  int count = 0;
-  int interval;
-  int burst;
+private:
+  std::atomic<uint64_t> state;
 };
 
-} // namespace openrasp
\ No newline at end of file
+} // namespace openrasp
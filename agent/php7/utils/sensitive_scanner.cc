@@ -0,0 +1,322 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensitive_scanner.h"
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace openrasp
+{
+
+static inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// same as \w of javascript regex
+static inline bool is_word(char c)
+{
+    return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static inline bool is_separator(char c)
+{
+    return c == ' ' || c == '-';
+}
+
+/**
+ * Skip non-digit bytes eight at a time, pages of markup rarely contain digits.
+ */
+static const char *find_digit(const char *p, const char *end)
+{
+    static const uint64_t ones = 0x0101010101010101ULL;
+    static const uint64_t highs = 0x8080808080808080ULL;
+    while (end - p >= 8)
+    {
+        uint64_t x;
+        memcpy(&x, p, sizeof(x));
+        // has a byte in ('0' - 1, '9' + 1)
+        uint64_t low7 = x & (ones * 127);
+        if (((ones * (127 + '9' + 1) - low7) & ~x & (low7 + ones * (127 - ('0' - 1))) & highs) != 0)
+        {
+            break;
+        }
+        p += 8;
+    }
+    while (p < end && !is_digit(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * count digits starting at pos are appended to out.
+ * @return position after the group, 0 if there is not enough digits
+ */
+static size_t take_digits(const char *data, size_t len, size_t pos, size_t count, std::string &out)
+{
+    for (size_t i = 0; i < count; ++i, ++pos)
+    {
+        if (pos >= len || !is_digit(data[pos]))
+        {
+            return 0;
+        }
+        out.push_back(data[pos]);
+    }
+    return pos;
+}
+
+bool SensitiveScanner::luhn_valid(const std::string &digits)
+{
+    size_t len = digits.length();
+    int sum = 0;
+    for (size_t i = len; i >= 1; --i)
+    {
+        int t = digits[len - i] - '0';
+        if (i % 2 == 0)
+        {
+            t *= 2;
+        }
+        sum += t / 10 + t % 10;
+    }
+    return len > 0 && sum % 10 == 0;
+}
+
+bool SensitiveScanner::identity_card_valid(const char *id)
+{
+    static const int weights[17] = {7, 9, 10, 5, 8, 4, 2, 1, 6, 3, 7, 9, 10, 5, 8, 4, 2};
+    int sum = 0;
+    for (int i = 0; i < 17; ++i)
+    {
+        sum += (id[i] - '0') * weights[i];
+    }
+    sum += (id[17] == 'x' || id[17] == 'X') ? 10 : id[17] - '0';
+    return sum % 11 == 1;
+}
+
+/**
+ * /(?<!\d)\d{10}(?:[01]\d)(?:[0123]\d)\d{3}(?:\d|x|X)(?!\d)/ with checksum
+ */
+size_t SensitiveScanner::match_identity_card(const char *data, size_t len, size_t pos) const
+{
+    size_t n = 0;
+    while (pos + n < len && n < 19 && is_digit(data[pos + n]))
+    {
+        ++n;
+    }
+    if (n == 17 && pos + 17 < len && (data[pos + 17] == 'x' || data[pos + 17] == 'X'))
+    {
+        if (pos + 18 < len && is_digit(data[pos + 18]))
+        {
+            return 0;
+        }
+    }
+    else if (n != 18)
+    {
+        return 0;
+    }
+    const char *id = data + pos;
+    if (id[0] == '0' || id[10] > '1' || id[12] > '3' || !identity_card_valid(id))
+    {
+        return 0;
+    }
+    return 18;
+}
+
+/**
+ * /(?<!\d)(?:62|3|5[1-5]|4\d)\d{2}(?:[ -]?\d{4}){3}(?!\d)/ with luhn
+ */
+size_t SensitiveScanner::match_bank_card(const char *data, size_t len, size_t pos) const
+{
+    if (pos + 1 >= len)
+    {
+        return 0;
+    }
+    char first = data[pos];
+    char second = data[pos + 1];
+    size_t head = 4;
+    if (first == '3')
+    {
+        head = 3;
+    }
+    else if (!((first == '6' && second == '2') ||
+               (first == '5' && second >= '1' && second <= '5') ||
+               (first == '4' && is_digit(second))))
+    {
+        return 0;
+    }
+    std::string digits;
+    size_t i = take_digits(data, len, pos, head, digits);
+    for (int group = 0; group < 3 && i > 0; ++group)
+    {
+        if (i < len && is_separator(data[i]))
+        {
+            ++i;
+        }
+        i = take_digits(data, len, i, 4, digits);
+    }
+    if (0 == i || (i < len && is_digit(data[i])) || !luhn_valid(digits))
+    {
+        return 0;
+    }
+    return i - pos;
+}
+
+/**
+ * /(1\d{2})(?:[ -]?\d){8}(?!\w)/ starting at pos, with a known carrier prefix
+ * @return end of the number, 0 if not matched
+ */
+size_t SensitiveScanner::match_phone(const char *data, size_t len, size_t pos) const
+{
+    static const int prefixes[] = {130, 131, 132, 133, 134, 135, 136, 137, 138, 139, 145, 146, 147, 148, 149,
+                                   150, 151, 152, 153, 155, 156, 157, 158, 159, 165, 166, 170, 173, 174, 175,
+                                   176, 177, 178, 180, 181, 182, 183, 184, 185, 186, 187, 188, 189, 198, 199};
+    if (pos + 3 > len || data[pos] != '1' || !is_digit(data[pos + 1]) || !is_digit(data[pos + 2]))
+    {
+        return 0;
+    }
+    int prefix = 100 + (data[pos + 1] - '0') * 10 + (data[pos + 2] - '0');
+    bool known = false;
+    for (int item : prefixes)
+    {
+        known = known || item == prefix;
+    }
+    if (!known)
+    {
+        return 0;
+    }
+    size_t i = pos + 3;
+    for (int n = 0; n < 8; ++n)
+    {
+        if (i + 1 < len && is_separator(data[i]) && is_digit(data[i + 1]))
+        {
+            ++i;
+        }
+        if (i >= len || !is_digit(data[i]))
+        {
+            return 0;
+        }
+        ++i;
+    }
+    if (i < len && is_word(data[i]))
+    {
+        return 0;
+    }
+    return i;
+}
+
+size_t SensitiveScanner::scan(const char *data, size_t len, std::vector<Candidate> &candidates, size_t max_candidates) const
+{
+    size_t count = 0;
+    size_t phones = 0;
+    size_t identity_cards = 0;
+    size_t bank_cards = 0;
+    const char *end = data + len;
+    const char *p = data;
+    while (((kinds & PHONE) && phones < max_candidates) ||
+           ((kinds & IDENTITY_CARD) && identity_cards < max_candidates) ||
+           ((kinds & BANK_CARD) && bank_cards < max_candidates))
+    {
+        p = find_digit(p, end);
+        if (p == end)
+        {
+            break;
+        }
+        size_t pos = p - data;
+        size_t matched = 0;
+        Kind kind = PHONE;
+        if ((kinds & IDENTITY_CARD) && (matched = match_identity_card(data, len, pos)) > 0)
+        {
+            kind = IDENTITY_CARD;
+        }
+        else if ((kinds & BANK_CARD) && (matched = match_bank_card(data, len, pos)) > 0)
+        {
+            kind = BANK_CARD;
+        }
+        else if (kinds & PHONE)
+        {
+            // (?<!\w)(?:(?:00|\+)?86 ?)? in front of the number
+            bool bounded = 0 == pos || !is_word(data[pos - 1]);
+            size_t phone_end = bounded ? match_phone(data, len, pos) : 0;
+            if (0 == phone_end && bounded && pos + 2 <= len && 0 == memcmp(p, "86", 2))
+            {
+                phone_end = match_phone(data, len, pos + 2);
+            }
+            if (0 == phone_end && bounded && pos + 4 <= len && 0 == memcmp(p, "0086", 4))
+            {
+                phone_end = match_phone(data, len, pos + 4);
+            }
+            matched = phone_end > 0 ? phone_end - pos : 0;
+        }
+        if (matched > 0)
+        {
+            size_t &kind_count = PHONE == kind ? phones : (IDENTITY_CARD == kind ? identity_cards : bank_cards);
+            if (kind_count < max_candidates)
+            {
+                candidates.push_back({pos, matched, kind});
+                ++kind_count;
+                ++count;
+            }
+            p += matched;
+            continue;
+        }
+        while (p < end && is_digit(*p))
+        {
+            ++p;
+        }
+    }
+    return count;
+}
+
+std::string SensitiveScanner::excerpt(const char *data, size_t len, const std::vector<Candidate> &candidates, size_t context)
+{
+    std::string result;
+    size_t last_end = 0;
+    for (auto &candidate : candidates)
+    {
+        size_t start = candidate.offset > context ? candidate.offset - context : 0;
+        size_t end = std::min(len, candidate.offset + candidate.length + context);
+        while (start > 0 && start < candidate.offset && is_word(data[start - 1]) && is_word(data[start]))
+        {
+            ++start;
+        }
+        while (end < len && end > candidate.offset + candidate.length && is_word(data[end - 1]) && is_word(data[end]))
+        {
+            --end;
+        }
+        if (!result.empty() && start <= last_end)
+        {
+            if (end > last_end)
+            {
+                result.append(data + last_end, end - last_end);
+            }
+        }
+        else
+        {
+            if (!result.empty())
+            {
+                result.push_back('\n');
+            }
+            result.append(data + start, end - start);
+        }
+        last_end = std::max(last_end, end);
+    }
+    return result;
+}
+
+} // namespace openrasp
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2017-2021 Baidu Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _OPENRASP_UTILS_SENSITIVE_SCANNER_H_
+#define _OPENRASP_UTILS_SENSITIVE_SCANNER_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace openrasp
+{
+
+/**
+ * Native pre-scanner for the response_dataLeak algorithm of the official plugin.
+ * It looks for the same shapes as the plugin regexes (identity card, mobile number, bank card)
+ * and validates them (checksum, number prefix, Luhn), so that the plugin only has to run
+ * on small excerpts around real candidates, or not at all.
+ */
+class SensitiveScanner
+{
+public:
+  enum Kind
+  {
+    PHONE = 1 << 0,
+    IDENTITY_CARD = 1 << 1,
+    BANK_CARD = 1 << 2,
+    ALL_KINDS = PHONE | IDENTITY_CARD | BANK_CARD
+  };
+
+  struct Candidate
+  {
+    size_t offset;
+    size_t length;
+    Kind kind;
+  };
+
+  static const size_t default_max_candidates = 16;
+  static const size_t default_context = 40;
+
+  explicit SensitiveScanner(int kinds = ALL_KINDS) : kinds(kinds) {}
+
+  /**
+   * scanning goes on until every kind looked for has max_candidates, so that many numbers of one kind
+   * do not hide another kind further down
+   * @return number of candidates appended, at most max_candidates of each kind
+   */
+  size_t scan(const char *data, size_t len, std::vector<Candidate> &candidates,
+              size_t max_candidates = default_max_candidates) const;
+
+  /**
+   * candidates with context bytes around them joined by '\n', windows never cut a word in half
+   * so that the plugin regexes see the same boundaries as in the whole content.
+   */
+  static std::string excerpt(const char *data, size_t len, const std::vector<Candidate> &candidates,
+                             size_t context = default_context);
+
+  static bool luhn_valid(const std::string &digits);
+  static bool identity_card_valid(const char *id);
+
+private:
+  int kinds;
+
+  size_t match_identity_card(const char *data, size_t len, size_t pos) const;
+  size_t match_bank_card(const char *data, size_t len, size_t pos) const;
+  size_t match_phone(const char *data, size_t len, size_t pos) const;
+};
+
+} // namespace openrasp
+
+#endif
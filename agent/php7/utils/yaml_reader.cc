@@ -296,6 +296,10 @@ std::string YamlReader::detect_unknown_config_key()
         "plugin.timeout.millis",
         "plugin.maxstack",
         "plugin.filter",
+        "plugin.budget.millis",
+        "plugin.budget.sample_interval",
+        "plugin.budget.degrade",
+        "plugin.budget.overload_percent",
         "log.maxburst",
         "log.maxstack",
         "log.maxbackup",
@@ -314,6 +318,7 @@ std::string YamlReader::detect_unknown_config_key()
         "inject.urlprefix",
         "inject.custom_headers",
         "body.maxbytes",
+        "body.json_maxbytes",
         "clientip.header",
         "security.weak_passwords",
         "lru.max_size",
@@ -321,6 +326,11 @@ std::string YamlReader::detect_unknown_config_key()
         "hook.white",
         "response.sampler_interval",
         "response.sampler_burst",
+        "response.sampler_prefix",
+        "response.chunk_size",
+        "response.finish_early",
+        "dns.cache_ttl",
+        "dns.negative_ttl",
         "decompile.enable"};
     std::vector<std::string> found_keys = fetch_object_keys({});
     for (auto &key : found_keys)